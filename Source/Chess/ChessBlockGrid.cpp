@@ -1,8 +1,11 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ChessBlockGrid.h"
+#include "Async/Async.h"
 #include "Components/TextRenderComponent.h"
 #include "Engine/World.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/Paths.h"
 
 #define LOCTEXT_NAMESPACE "PuzzleBlockGrid"
 
@@ -61,6 +64,42 @@ void AChessBlockGrid::BeginPlay()
 	{
 		m_Grid[idx]->Highlight(m_Board.BoardState.WhiteThreatMap.IsThreatened(idx));
 	}
+
+	if (bEngineOpponent)
+	{
+		int32 threads = EngineThreads > 0 ? EngineThreads : FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads() - 1, 1);
+		m_Engine = MakeUnique<EngineWorker>(EngineHashMB, threads);
+		if (m_Engine->GetHashMB() == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("No memory for the engine's %d MB table, it will search without one"), EngineHashMB);
+		}
+
+		if (!EngineNetworkFile.IsEmpty())
+		{
+			std::shared_ptr<Nnue::Network> network = std::make_shared<Nnue::Network>();
+			FString path = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir(), EngineNetworkFile);
+			if (network->Load(TCHAR_TO_UTF8(*path)))
+			{
+				m_Engine->SetNetwork(network);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Couldn't load the engine network from %s, using the built in evaluation"), *path);
+			}
+		}
+
+		StartEngineIfToMove();
+	}
+}
+
+void AChessBlockGrid::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//Joins the worker, anything it already sent back finds the grid gone and does nothing
+	m_EngineSearchId = 0;
+	m_PonderSearchId = 0;
+	m_Engine.Reset();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 APieceActor* AChessBlockGrid::SpawnPiece(int32 Piece, AChessBlock& square)
@@ -82,7 +121,7 @@ APieceActor* AChessBlockGrid::SpawnPiece(int32 Piece, AChessBlock& square)
 	return spawnedPiece;
 }
 
-void AChessBlockGrid::MovePiece(APieceActor& Piece, AChessBlock& OriginSquare, AChessBlock* TargetSquare)
+void AChessBlockGrid::MovePiece(AChessBlock& OriginSquare, AChessBlock* TargetSquare)
 {
 	int32 startIDX = m_Grid.Find(&OriginSquare);
 	int32 endIDX = m_Grid.Find(TargetSquare);
@@ -94,70 +133,175 @@ void AChessBlockGrid::MovePiece(APieceActor& Piece, AChessBlock& OriginSquare, A
 	FString end = FString(Utils::SquareName(endIDX).c_str());
 	UE_LOG(LogTemp, Display, TEXT("Moving %s from square %s (%d) to %s (%d)"), *name, *start, Utils::SquareFromName(Utils::SquareName(startIDX).c_str()), *end, Utils::SquareFromName(Utils::SquareName(endIDX).c_str()));
 
-	Chess::Move move = Move::CreateMove(m_Board.BoardState, startIDX, endIDX, p & ~Piece::ClassMask);
+	Chess::Move move = Move::CreateMove(startIDX, endIDX);
 	if (Utils::IsType(p, Piece::King))
 	{
-		if ((Utils::IsColour(p, Piece::White) && endIDX == 1 || endIDX == 2) || (Utils::IsColour(p, Piece::Black) && (endIDX == 57 || endIDX == 58)))
+		if ((Utils::IsColour(p, Piece::White) && (endIDX == 1 || endIDX == 2)) || (Utils::IsColour(p, Piece::Black) && (endIDX == 57 || endIDX == 58)))
 		{
-			Chess::Move castle = Move::CreateCastlingMove(m_Board.BoardState, p & ~Piece::ClassMask, Castling::Queenside);
+			Chess::Move castle = Move::CreateCastlingMove(p & ~Piece::ClassMask, Castling::Queenside);
 			if (m_Board.IsValidMove(castle))
 			{
 				move = castle;
-				TargetSquare = m_Grid[move.TargetSquare];
 			}
 		}
 		else if ((Utils::IsColour(p, Piece::White) && endIDX == 6) || (Utils::IsColour(p, Piece::Black) && endIDX == 62))
 		{
-			Chess::Move castle = Move::CreateCastlingMove(m_Board.BoardState, p & ~Piece::ClassMask, Castling::Kingside);
+			Chess::Move castle = Move::CreateCastlingMove(p & ~Piece::ClassMask, Castling::Kingside);
 			if (m_Board.IsValidMove(castle))
 			{
 				move = castle;
-				TargetSquare = m_Grid[move.TargetSquare];
 			}
 		}
 	}
 
-	if (m_Board.MakeMove(move))
+	PlayMove(move);
+}
+
+bool AChessBlockGrid::PlayMove(Chess::Move& move)
+{
+	//Names are only generated on demand, and need the position from before the move
+	if (!m_Board.IsValidMove(move))
+	{
+		return false;
+	}
+
+	int32 p = m_Board.BoardState.Squares[move.StartSquare()];
+	AChessBlock* OriginSquare = m_Grid[move.StartSquare()];
+	AChessBlock* TargetSquare = m_Grid[move.TargetSquare()];
+	APieceActor& Piece = *OriginSquare->OccupyingPiece;
+
+	FString moveName(move.GenerateAlgebraicName(m_Board.BoardState).c_str());
+	if (!m_Board.MakeMove(move))
 	{
-		UE_LOG(LogTemp, Display, TEXT("%s"), *FString(move.ToString().c_str()));
-		OriginSquare.OccupyingPiece = nullptr;
+		return false;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("%s"), *moveName);
+	OriginSquare->OccupyingPiece = nullptr;
 
-		if (TargetSquare->OccupyingPiece != nullptr)
+	if (TargetSquare->OccupyingPiece != nullptr)
+	{
+		TargetSquare->OccupyingPiece->TakePiece();
+		TargetSquare->OccupyingPiece = nullptr;
+	}
+
+	Piece.MoveTo(TargetSquare->GetActorLocation());
+	TargetSquare->OccupySquare(&Piece);
+
+	if (move.SecondaryStart() != -1)
+	{
+		APieceActor* secondaryPiece = m_Grid[move.SecondaryStart()]->OccupyingPiece;
+		if (move.SecondaryTarget() != -1) //Target is -1 in case of en passent, a real value in the case of castling
+		{
+			secondaryPiece->MoveTo(m_Grid[move.SecondaryTarget()]->GetActorLocation());
+			m_Grid[move.SecondaryTarget()]->OccupySquare(secondaryPiece);
+			m_Grid[move.SecondaryStart()]->OccupyingPiece = nullptr;
+		}
+		else
 		{
-			TargetSquare->OccupyingPiece->TakePiece();
-			TargetSquare->OccupyingPiece = nullptr;
+			secondaryPiece->TakePiece();
+			m_Grid[move.SecondaryStart()]->OccupyingPiece = nullptr;
 		}
+	}
 
-		Piece.MoveTo(TargetSquare->GetActorLocation());
-		TargetSquare->OccupySquare(&Piece);
+	//At the moment, we just auto-promote to queen because I can't be arsed with the UI to select the underpromotions
+	//But all that needs to happen is that the move needs to include the desired promotion & it should 'just work'
+	if (move.IsPromotion())
+	{
+		Piece.SetPieceType(static_cast<Class>(move.Promote()), Utils::IsColour(p, Piece::Black));
+	}
 
-		if (move.SecondaryStart != -1)
+	for (int idx = 0; idx < 64; idx++)
+	{
+		m_Grid[idx]->Highlight(m_Board.BoardState.WhiteThreatMap.IsThreatened(idx));
+	}
+
+	//Whatever the engine was thinking about is out of date now, unless it was pondering this very move
+	if (m_Engine.IsValid())
+	{
+		if (m_PonderSearchId != 0 && move == m_PonderMove && m_Engine->PonderHit(EngineThinkMilliseconds))
 		{
-			APieceActor* secondaryPiece = m_Grid[move.SecondaryStart]->OccupyingPiece;
-			if (move.SecondaryTarget != -1) //Target is -1 in case of en passent, a real value in the case of castling
-			{
-				secondaryPiece->MoveTo(m_Grid[move.SecondaryTarget]->GetActorLocation());
-				m_Grid[move.SecondaryTarget]->OccupySquare(secondaryPiece);
-				m_Grid[move.SecondaryStart]->OccupyingPiece = nullptr;
-			}
-			else
-			{
-				secondaryPiece->TakePiece();
-				m_Grid[move.SecondaryStart]->OccupyingPiece = nullptr;
-			}
+			UE_LOG(LogTemp, Display, TEXT("Engine predicted %s"), *moveName);
+			m_EngineSearchId = m_PonderSearchId;
 		}
-
-		//At the moment, we just auto-promote to queen because I can't be arsed with the UI to select the underpromotions
-		//But all that needs to happen is that the move needs to include the desired promotion & it should 'just work'
-		if (move.Promote != Piece::None)
+		else
 		{
-			Piece.SetPieceType(static_cast<Class>(move.Promote), Utils::IsColour(p, Piece::Black));
+			m_Engine->Cancel();
+			m_EngineSearchId = 0;
+			StartEngineIfToMove();
 		}
 
-		for (int idx = 0; idx < 64; idx++)
+		m_PonderSearchId = 0;
+		m_PonderMove = Chess::Move();
+	}
+
+	return true;
+}
+
+void AChessBlockGrid::StartEngineIfToMove()
+{
+	if (!m_Engine.IsValid() || m_Board.GetColourToMove() != Piece::Black)
+	{
+		return;
+	}
+
+	Search::Limits limits;
+	limits.MaxMilliseconds = EngineThinkMilliseconds;
+	m_EngineSearchId = StartEngineSearch(m_Board, limits, false);
+}
+
+void AChessBlockGrid::StartPondering(const Search::Result& result)
+{
+	if (!bEnginePonder || m_Board.GetColourToMove() == Piece::Black)
+	{
+		return;
+	}
+
+	//Think about the position after the reply the engine expects, as if the player had already made it. With no reply to
+	//expect, or none that's legal, think about the player's position instead
+	Board ponderBoard(m_Board);
+	m_PonderMove = result.PrincipalVariation.size() > 1 ? result.PrincipalVariation[1] : Chess::Move();
+	if (m_PonderMove.IsNull() || !ponderBoard.MakeMove(m_PonderMove))
+	{
+		m_PonderMove = Chess::Move();
+	}
+
+	m_PonderSearchId = StartEngineSearch(ponderBoard, Search::Limits(), true);
+}
+
+uint32 AChessBlockGrid::StartEngineSearch(const Board& board, const Search::Limits& limits, bool ponder)
+{
+	//The callback runs on the engine's thread, all it does is send the result back to the game thread. The grid may be gone by then
+	TWeakObjectPtr<AChessBlockGrid> weakGrid(this);
+	return m_Engine->StartSearch(board, limits, [weakGrid](uint32 searchId, const Search::Result& result)
+	{
+		AsyncTask(ENamedThreads::GameThread, [weakGrid, searchId, result]()
 		{
-			m_Grid[idx]->Highlight(m_Board.BoardState.WhiteThreatMap.IsThreatened(idx));
-		}
+			if (AChessBlockGrid* grid = weakGrid.Get())
+			{
+				grid->OnEngineSearchComplete(searchId, result);
+			}
+		});
+	}, ponder);
+}
+
+void AChessBlockGrid::OnEngineSearchComplete(uint32 searchId, const Search::Result& result)
+{
+	//A search cancelled after it finished can still get here, only the one we're waiting on counts
+	if (searchId != m_EngineSearchId)
+	{
+		return;
+	}
+
+	m_EngineSearchId = 0;
+	UE_LOG(LogTemp, Display, TEXT("Engine plays %s, scoring %d at depth %d after %lld nodes"), UTF8_TO_TCHAR(result.BestMove.ToString().c_str()),
+		result.Score, result.Depth, result.Nodes);
+
+	//No move means there was nothing legal to play, the game is over
+	Chess::Move move = result.BestMove;
+	if (!move.IsNull() && PlayMove(move))
+	{
+		StartPondering(result);
 	}
 }
 
@@ -165,6 +309,12 @@ void AChessBlockGrid::OnSquareClicked(AChessBlock* square)
 {
 	ensure(square != nullptr);
 
+	//The board's the engine's until it moves
+	if (m_EngineSearchId != 0)
+	{
+		return;
+	}
+
 	//If this is the first click, we're picking a piece to move
 	if (SelectedSquare == nullptr)
 	{
@@ -176,7 +326,7 @@ void AChessBlockGrid::OnSquareClicked(AChessBlock* square)
 	}
 	else
 	{
-		MovePiece(*SelectedSquare->OccupyingPiece, *SelectedSquare, square);
+		MovePiece(*SelectedSquare, square);
 
 		//SelectedSquare->Highlight(false);
 		SelectedSquare = nullptr;
@@ -185,6 +335,12 @@ void AChessBlockGrid::OnSquareClicked(AChessBlock* square)
 
 void AChessBlockGrid::CancelMove()
 {
+	//Cancelling while the engine thinks hurries it up, it plays the best move it's found so far
+	if (m_EngineSearchId != 0)
+	{
+		m_Engine->Stop();
+	}
+
 	if (SelectedSquare != nullptr)
 	{
 		SelectedSquare->Highlight(false);
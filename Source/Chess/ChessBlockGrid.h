@@ -7,6 +7,7 @@
 #include "ChessBlock.h"
 #include "PieceActor.h"
 #include "Core/Board.h"
+#include "Core/EngineWorker.h"
 
 #include "ChessBlockGrid.generated.h"
 
@@ -26,6 +27,15 @@ class AChessBlockGrid : public AActor
 	Board m_Board;
 
 	AChessBlock* SelectedSquare = nullptr;
+
+	//Thinks on its own thread, its moves come back to the game thread and are only played if they're for the search we're waiting on
+	TUniquePtr<EngineWorker> m_Engine;
+	uint32 m_EngineSearchId = 0;
+
+	//The search run on the player's time, and the reply it expects. A null move means it's searching the player's own position,
+	//which can never be hit but leaves the table full of their replies
+	uint32 m_PonderSearchId = 0;
+	Chess::Move m_PonderMove;
 public:
 	AChessBlockGrid();
 
@@ -36,14 +46,46 @@ public:
 	UPROPERTY(Category = Grid, EditAnywhere)
 	TSubclassOf<APieceActor> PieceTemplate;
 
+	/** Whether the engine plays black against the player */
+	UPROPERTY(Category = Engine, EditAnywhere, BlueprintReadWrite)
+	bool bEngineOpponent = false;
+
+	/** How long the engine thinks about each move */
+	UPROPERTY(Category = Engine, EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	int32 EngineThinkMilliseconds = 2000;
+
+	/** Threads the engine searches with, 0 for all but one core which is left for the game */
+	UPROPERTY(Category = Engine, EditAnywhere, meta = (ClampMin = "0"))
+	int32 EngineThreads = 0;
+
+	UPROPERTY(Category = Engine, EditAnywhere, meta = (ClampMin = "1"))
+	int32 EngineHashMB = 64;
+
+	/** Whether the engine keeps thinking while the player chooses their move */
+	UPROPERTY(Category = Engine, EditAnywhere, BlueprintReadWrite)
+	bool bEnginePonder = true;
+
+	/** NNUE network file the engine evaluates with, relative to the project directory. Empty for the built in evaluation */
+	UPROPERTY(Category = Engine, EditAnywhere)
+	FString EngineNetworkFile;
+
 protected:
 	// Begin AActor interface
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	// End AActor interface
 
 private:
 	APieceActor* SpawnPiece(int32 Piece, AChessBlock& square);
-	void MovePiece(APieceActor& Piece, AChessBlock& OriginSquare, AChessBlock* TargetSquare);
+	void MovePiece(AChessBlock& OriginSquare, AChessBlock* TargetSquare);
+
+	//Plays a move on the board and moves the pieces to match, false if it isn't legal
+	bool PlayMove(Chess::Move& move);
+
+	void StartEngineIfToMove();
+	void StartPondering(const Search::Result& result);
+	uint32 StartEngineSearch(const Board& board, const Search::Limits& limits, bool ponder);
+	void OnEngineSearchComplete(uint32 searchId, const Search::Result& result);
 
 public:
 	/** Returns DummyRoot subobject **/
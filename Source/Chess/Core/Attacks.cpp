@@ -0,0 +1,189 @@
+#include "Attacks.h"
+
+#include "Utils.h"
+
+#include <vector>
+
+namespace Chess
+{
+	namespace
+	{
+		//{ rank, file } steps
+		const int8 RookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, -1 }, { 0, 1 } };
+		const int8 BishopDirections[4][2] = { { 1, -1 }, { -1, 1 }, { 1, 1 }, { -1, -1 } };
+
+		//Reference ray walk, only used to fill the tables
+		uint64 SlidingAttacks(int8 square, uint64 occupancy, const int8 directions[4][2])
+		{
+			uint64 attacks = Bitboard::Empty;
+			for (int8 directionIndex = 0; directionIndex < 4; directionIndex++)
+			{
+				int8 rank = Utils::RankIndex(square) + directions[directionIndex][0];
+				int8 file = Utils::FileIndex(square) + directions[directionIndex][1];
+
+				while (rank >= 0 && rank < 8 && file >= 0 && file < 8)
+				{
+					uint64 target = Bitboard::SquareMask(Utils::IndexFromCoord(rank, file));
+					attacks |= target;
+					if ((occupancy & target) != Bitboard::Empty)
+					{
+						break;
+					}
+
+					rank += directions[directionIndex][0];
+					file += directions[directionIndex][1];
+				}
+			}
+
+			return attacks;
+		}
+
+		//Pieces on the edge of the board can't block anything behind them, so they're left out of the index unless the slider is on that edge
+		uint64 RelevantOccupancy(int8 square, const int8 directions[4][2])
+		{
+			uint64 rankMask = Bitboard::Rank1 << (8 * Utils::RankIndex(square));
+			uint64 fileMask = Bitboard::FileA << Utils::FileIndex(square);
+			uint64 edges = ((Bitboard::Rank1 | Bitboard::Rank8) & ~rankMask) | ((Bitboard::FileA | Bitboard::FileH) & ~fileMask);
+
+			return SlidingAttacks(square, Bitboard::Empty, directions) & ~edges;
+		}
+	}
+
+	namespace Attacks
+	{
+		const Tables AttackTables;
+
+		Tables::Tables()
+		{
+			InitialiseSlider(RookMagics, RookTable, RookDirections);
+			InitialiseSlider(BishopMagics, BishopTable, BishopDirections);
+			InitialiseLeapers();
+			InitialiseLines();
+		}
+
+		void Tables::InitialiseLeapers()
+		{
+			const int8 KnightSteps[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+			const int8 KingSteps[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+			const int8 PawnSteps[2][2][2] = { { { 1, -1 }, { 1, 1 } }, { { -1, -1 }, { -1, 1 } } };
+
+			auto stepTo = [](int8 square, const int8 step[2]) -> uint64
+			{
+				int8 rank = Utils::RankIndex(square) + step[0];
+				int8 file = Utils::FileIndex(square) + step[1];
+				return (rank >= 0 && rank < 8 && file >= 0 && file < 8) ? Bitboard::SquareMask(Utils::IndexFromCoord(rank, file)) : Bitboard::Empty;
+			};
+
+			for (int8 square = 0; square < 64; square++)
+			{
+				KnightAttacks[square] = Bitboard::Empty;
+				KingAttacks[square] = Bitboard::Empty;
+				for (int8 stepIdx = 0; stepIdx < 8; stepIdx++)
+				{
+					KnightAttacks[square] |= stepTo(square, KnightSteps[stepIdx]);
+					KingAttacks[square] |= stepTo(square, KingSteps[stepIdx]);
+				}
+
+				for (int8 colourIdx = 0; colourIdx < 2; colourIdx++)
+				{
+					PawnAttacks[colourIdx][square] = stepTo(square, PawnSteps[colourIdx][0]) | stepTo(square, PawnSteps[colourIdx][1]);
+				}
+			}
+		}
+
+		void Tables::InitialiseLines()
+		{
+			for (int8 from = 0; from < 64; from++)
+			{
+				for (int8 to = 0; to < 64; to++)
+				{
+					BetweenSquares[from][to] = Bitboard::Empty;
+					LineThrough[from][to] = Bitboard::Empty;
+
+					uint64 toMask = Bitboard::SquareMask(to);
+					const int8 (*directions)[2] = nullptr;
+					if ((SlidingAttacks(from, Bitboard::Empty, RookDirections) & toMask) != Bitboard::Empty)
+					{
+						directions = RookDirections;
+					}
+					else if ((SlidingAttacks(from, Bitboard::Empty, BishopDirections) & toMask) != Bitboard::Empty)
+					{
+						directions = BishopDirections;
+					}
+
+					if (directions != nullptr)
+					{
+						uint64 fromMask = Bitboard::SquareMask(from);
+						BetweenSquares[from][to] = SlidingAttacks(from, toMask, directions) & SlidingAttacks(to, fromMask, directions);
+						LineThrough[from][to] = (SlidingAttacks(from, Bitboard::Empty, directions) & SlidingAttacks(to, Bitboard::Empty, directions)) | fromMask | toMask;
+					}
+				}
+			}
+		}
+
+		void Tables::InitialiseSlider(Magic* magics, uint64* table, const int8 directions[4][2])
+		{
+			//Scratch space for the largest (rook in a corner, 12 relevant squares) subset enumeration
+			std::vector<uint64> occupancies(4096);
+			std::vector<uint64> reference(4096);
+			std::vector<int32> epoch(4096, 0);
+
+			Utils::Random random(1070372ULL);
+			int32 attempt = 0;
+
+			uint64* tableEntry = table;
+			for (int8 square = 0; square < 64; square++)
+			{
+				Magic& magic = magics[square];
+				magic.Mask = RelevantOccupancy(square, directions);
+				magic.Shift = 64 - Bitboard::PopCount(magic.Mask);
+				magic.Multiplier = 0;
+				magic.Attacks = tableEntry;
+
+				//Enumerate every subset of the mask (Carry-Rippler) along with the attacks it produces
+				int32 size = 0;
+				uint64 subset = Bitboard::Empty;
+				do
+				{
+					occupancies[size] = subset;
+					reference[size] = SlidingAttacks(square, subset, directions);
+					size++;
+					subset = (subset - magic.Mask) & magic.Mask;
+				} while (subset != Bitboard::Empty);
+
+#if CHESS_USE_PEXT
+				for (int32 idx = 0; idx < size; idx++)
+				{
+					tableEntry[magic.Index(occupancies[idx])] = reference[idx];
+				}
+#else
+				//Try multipliers until every subset lands on a slot that is either unused or already holds the same attack set
+				for (int32 idx = 0; idx < size;)
+				{
+					do
+					{
+						magic.Multiplier = random.Sparse();
+					} while (Bitboard::PopCount((magic.Mask * magic.Multiplier) >> 56) < 6);
+
+					attempt++;
+					for (idx = 0; idx < size; idx++)
+					{
+						uint32 slot = magic.Index(occupancies[idx]);
+						if (epoch[slot] < attempt)
+						{
+							epoch[slot] = attempt;
+							tableEntry[slot] = reference[idx];
+						}
+						else if (tableEntry[slot] != reference[idx])
+						{
+							break;
+						}
+					}
+				}
+#endif
+
+				tableEntry += size;
+			}
+		}
+	}
+}
\ No newline at end of file
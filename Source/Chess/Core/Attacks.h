@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Bitboard.h"
+
+//Use the BMI2 PEXT instruction to index the sliding tables where the target CPU has it, otherwise fall back to magic multiplication
+#if !defined(CHESS_USE_PEXT)
+#if defined(__BMI2__)
+#define CHESS_USE_PEXT 1
+#else
+#define CHESS_USE_PEXT 0
+#endif
+#endif
+
+#if CHESS_USE_PEXT
+#include <immintrin.h>
+#endif
+
+namespace Chess
+{
+	namespace Attacks
+	{
+		//Everything needed to turn the occupancy of a slider's relevant squares into an index into its attack table
+		struct Magic
+		{
+			uint64 Mask;
+			uint64 Multiplier;
+			const uint64* Attacks;
+			int8 Shift;
+
+			inline uint32 Index(uint64 occupancy) const
+			{
+#if CHESS_USE_PEXT
+				return static_cast<uint32>(_pext_u64(occupancy, Mask));
+#else
+				return static_cast<uint32>(((occupancy & Mask) * Multiplier) >> Shift);
+#endif
+			}
+		};
+
+		/*
+			Precomputed attack tables. There is a single instance, built during static initialisation, which is only
+			ever read afterwards so it can be shared between any number of boards and threads.
+		*/
+		struct Tables
+		{
+		public:
+			Tables();
+
+			Magic RookMagics[64];
+			Magic BishopMagics[64];
+
+			uint64 KnightAttacks[64];
+			uint64 KingAttacks[64];
+			uint64 PawnAttacks[2][64];
+
+			//Squares strictly between two squares that share a rank, file or diagonal, and the whole line through them
+			uint64 BetweenSquares[64][64];
+			uint64 LineThrough[64][64];
+
+		private:
+			void InitialiseSlider(Magic* magics, uint64* table, const int8 directions[4][2]);
+			void InitialiseLeapers();
+			void InitialiseLines();
+
+			//Sizes are the sum over all squares of 2^(number of relevant occupancy squares)
+			uint64 RookTable[0x19000];
+			uint64 BishopTable[0x1480];
+		};
+
+		extern const Tables AttackTables;
+
+		inline uint64 Rook(int8 square, uint64 occupancy)
+		{
+			const Magic& magic = AttackTables.RookMagics[square];
+			return magic.Attacks[magic.Index(occupancy)];
+		}
+
+		inline uint64 Bishop(int8 square, uint64 occupancy)
+		{
+			const Magic& magic = AttackTables.BishopMagics[square];
+			return magic.Attacks[magic.Index(occupancy)];
+		}
+
+		inline uint64 Queen(int8 square, uint64 occupancy) { return Rook(square, occupancy) | Bishop(square, occupancy); }
+
+		inline uint64 Knight(int8 square) { return AttackTables.KnightAttacks[square]; }
+		inline uint64 King(int8 square) { return AttackTables.KingAttacks[square]; }
+
+		//Squares a pawn of the given colour index attacks from square
+		inline uint64 Pawn(int8 colourIdx, int8 square) { return AttackTables.PawnAttacks[colourIdx][square]; }
+
+		//Every square attacked by a set of pawns of the given colour index, shifting the whole set at once
+		inline uint64 PawnSet(int8 colourIdx, uint64 pawns)
+		{
+			return colourIdx == 0 ?
+				((pawns & ~Bitboard::FileA) << 7) | ((pawns & ~Bitboard::FileH) << 9) :
+				((pawns & ~Bitboard::FileA) >> 9) | ((pawns & ~Bitboard::FileH) >> 7);
+		}
+
+		inline uint64 Between(int8 from, int8 to) { return AttackTables.BetweenSquares[from][to]; }
+		inline uint64 Line(int8 from, int8 to) { return AttackTables.LineThrough[from][to]; }
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Chess
+{
+	/*
+		A bitboard is a set of squares packed into a 64 bit integer, bit n being set if square n (a1 = 0, h8 = 63) is in the set.
+		These helpers are the primitive operations the generators use to walk those sets without scanning the whole board.
+	*/
+	namespace Bitboard
+	{
+		const uint64 Empty = 0ULL;
+		const uint64 FileA = 0x0101010101010101ULL;
+		const uint64 FileH = FileA << 7;
+		const uint64 Rank1 = 0xFFULL;
+		const uint64 Rank8 = Rank1 << 56;
+
+		inline uint64 SquareMask(int8 square) { return 1ULL << square; }
+		inline bool Contains(uint64 bitboard, int8 square) { return (bitboard & SquareMask(square)) != 0; }
+
+		inline int8 LSB(uint64 bitboard)
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward64(&index, bitboard);
+			return static_cast<int8>(index);
+#else
+			return static_cast<int8>(__builtin_ctzll(bitboard));
+#endif
+		}
+
+		inline int8 PopCount(uint64 bitboard)
+		{
+#if defined(_MSC_VER)
+			return static_cast<int8>(__popcnt64(bitboard));
+#else
+			return static_cast<int8>(__builtin_popcountll(bitboard));
+#endif
+		}
+
+		//Removes the lowest set square from the bitboard and returns it
+		inline int8 PopLSB(uint64& bitboard)
+		{
+			int8 square = LSB(bitboard);
+			bitboard &= bitboard - 1;
+			return square;
+		}
+	}
+}
\ No newline at end of file
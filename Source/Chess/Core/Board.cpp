@@ -4,44 +4,94 @@
 
 #include "MoveGeneration.h"
 
+#include <algorithm>
+
 namespace Chess
 {
 	using namespace Constants;
 
 	Board::Board():
-		BoardState(StandardStartFEN)
+		Board(StandardStartFEN)
 	{}
 
+	Board::Board(const std::string& fen) :
+		BoardState(fen), NnueNetwork(nullptr)
+	{
+		History.reserve(ExpectedGameLength);
+	}
+
 	bool Board::MakeMove(Move& move)
 	{
 		if (IsValidMove(move))
 		{
-			StateHistory.push(BoardState);
-
-			BoardState.Update(move);
+			ApplyMove(move);
 			return true;
 		}
 
 		return false;
 	}
 
+	void Board::ApplyMove(const Move& move)
+	{
+		//What the move changes has to be read off the position before it's made
+		if (NnueNetwork != nullptr)
+		{
+			Accumulators.emplace_back();
+			Nnue::RecordMove(BoardState, move, Accumulators.back());
+		}
+
+		History.push_back(BoardState.Update(move));
+	}
+
 	bool Board::UnmakeMove()
 	{
-		if (StateHistory.size() > 0)
+		if (History.size() > 0)
 		{
-			BoardState = StateHistory.top();
-			StateHistory.pop();
+			BoardState.Revert(History.back());
+			History.pop_back();
+
+			if (NnueNetwork != nullptr)
+			{
+				Accumulators.pop_back();
+			}
+
 			return true;
 		}
 
 		return false;
 	}
 
+	void Board::SetNetwork(const Nnue::Network* network)
+	{
+		NnueNetwork = network;
+
+		//Nothing is worked out until a position is evaluated, the first evaluation refreshes from the current position
+		Accumulators.clear();
+		if (NnueNetwork != nullptr)
+		{
+			Accumulators.reserve(ExpectedGameLength);
+			Accumulators.resize(History.size() + 1);
+			for (Nnue::Accumulator& accumulator : Accumulators)
+			{
+				accumulator.Computed[0] = false;
+				accumulator.Computed[1] = false;
+				accumulator.Dirty.Count = 0;
+			}
+		}
+	}
+
 	bool Board::IsValidMove(Move& move) const
 	{
-		std::vector<Move> validMoves = MoveGeneration::GenerateMoves(BoardState, BoardState.ColourToMove);
+		MoveList validMoves;
+		MoveGeneration::GenerateMoves(BoardState, BoardState.ColourToMove, validMoves);
+
+		//The caller may only know the squares involved, so match on those (and the promotion if one was asked for) then fill in the rest
+		auto validatedMove = std::find_if(validMoves.begin(), validMoves.end(), [&move](const Move& validMove)
+		{
+			return validMove.StartSquare() == move.StartSquare() && validMove.TargetSquare() == move.TargetSquare() &&
+				(!move.IsPromotion() || validMove.Promote() == move.Promote());
+		});
 
-		auto validatedMove = std::find(validMoves.begin(), validMoves.end(), move);
 		bool moveIsValid = validatedMove != validMoves.end();
 		if (moveIsValid)
 		{
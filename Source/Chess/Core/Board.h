@@ -3,10 +3,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include <stack>
+#include <vector>
 
 #include "Constants.h"
 #include "Move.h"
+#include "Nnue.h"
 #include "Utils.h"
 #include "State.h"
 
@@ -19,16 +20,36 @@ namespace Chess
 	{
 	public:
 		Board();
+		Board(const std::string& fen);
 
 		bool MakeMove(Move& move);
 		bool IsValidMove(Move& move) const;
 		bool UnmakeMove();
 
+		//Skips validation, the move must have been generated for the current position
+		void ApplyMove(const Move& move);
+
 		inline int8 GetEnPassentTarget() const { return BoardState.EnPassentTarget; }
 		inline int8 GetColourToMove() const { return BoardState.ColourToMove; }
 		inline int8 GetCastleAvailability(int8 colour) const { return Utils::IsColour(colour, Constants::Piece::White) ? BoardState.WhiteCastleAvailable : BoardState.BlackCastleAvailable; }
+		inline int32 GetPly() const { return static_cast<int32>(History.size()); }
+		inline uint64 GetKey() const { return BoardState.Key; }
+
+		//Keeps accumulators for the network as moves are made so it can evaluate positions incrementally, null to stop. The
+		//network isn't owned and has to outlive the board and every copy of it
+		void SetNetwork(const Nnue::Network* network);
+		inline const Nnue::Network* GetNetwork() const { return NnueNetwork; }
 	public:
 		State BoardState;
-		std::stack<State> StateHistory;
+		std::vector<UndoRecord> History;
+
+		//One for the position before each move in History and one for the current position, empty without a network
+		std::vector<Nnue::Accumulator> Accumulators;
+
+	private:
+		//Reserved up front so making moves doesn't allocate in any reasonable game
+		static const int32 ExpectedGameLength = 1024;
+
+		const Nnue::Network* NnueNetwork;
 	};
 }
\ No newline at end of file
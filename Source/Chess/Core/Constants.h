@@ -39,40 +39,21 @@ namespace Chess
 			const int8 ClassMask = 0x7;
 		}
 
+		namespace MoveFlag
+		{
+			const uint8 Quiet = 0;
+			const uint8 DoublePawnPush = 1;
+			const uint8 KingsideCastle = 2;
+			const uint8 QueensideCastle = 3;
+			const uint8 Capture = 4;
+			const uint8 EnPassentCapture = 5;
+			const uint8 Promotion = 8; //Low two bits select the piece, combined with Capture for capturing promotions
+		}
+
 		const int8 Promotions[4]{ Piece::Queen, Piece::Rook, Piece::Knight, Piece::Bishop };
 
 		namespace
 		{
-			struct ToEdge
-			{
-				constexpr ToEdge() : arr()
-				{
-					for (int8 file = 0; file < 8; file++)
-					{
-						for (int8 rank = 0; rank < 8; rank++)
-						{
-							int8 numNorth = 7 - rank;
-							int8 numSouth = rank;
-							int8 numWest = file;
-							int8 numEast = 7 - file;
-
-							int8 squareIdx = rank * 8 + file;
-
-							arr[squareIdx][0] = numNorth;
-							arr[squareIdx][1] = numSouth;
-							arr[squareIdx][2] = numWest;
-							arr[squareIdx][3] = numEast;
-							arr[squareIdx][4] = std::min(numNorth, numWest);
-							arr[squareIdx][5] = std::min(numSouth, numEast);
-							arr[squareIdx][6] = std::min(numNorth, numEast);
-							arr[squareIdx][7] = std::min(numSouth, numWest);
-						}
-					}
-				}
-
-				int8 arr[64][8];
-			};
-
 			struct Initialiser
 			{
 				static std::map<char, int8> ConstructMap()
@@ -92,6 +73,5 @@ namespace Chess
 		} //Anonymous namespace to initialise the PieceTypeFromSymbol map
 
 		const std::map<char, int8> PieceTypeFromSymbol = Initialiser::ConstructMap();
-		static int8 NumSquaresToEdge[64][8] = ToEdge().arr;
 	}
 }
\ No newline at end of file
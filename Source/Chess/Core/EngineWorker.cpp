@@ -0,0 +1,194 @@
+#include "EngineWorker.h"
+
+#include <algorithm>
+
+namespace Chess
+{
+	EngineWorker::EngineWorker(int32 hashMB, int32 threads) :
+		Table(hashMB), Searcher(Table, threads), RunningId(0), LastId(0), ShuttingDown(false), StopPending(false), Pondering(false),
+		PonderHitPending(false), PonderHitMilliseconds(0), CancelledId(0)
+	{
+		//Started last, everything it touches has to be set up first
+		Worker = std::thread(&EngineWorker::WorkerLoop, this);
+	}
+
+	EngineWorker::~EngineWorker()
+	{
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			CancelLocked();
+			ShuttingDown = true;
+		}
+
+		Wake.notify_all();
+		Worker.join();
+	}
+
+	uint32 EngineWorker::StartSearch(const Board& board, const Search::Limits& limits, const CompletionCallback& onComplete, bool ponder /*= false*/)
+	{
+		//Copied outside the lock, the worker never needs to wait on the caller's board
+		std::unique_ptr<Request> request(new Request{ 0, board, limits, onComplete, nullptr });
+		if (ponder)
+		{
+			request->Limits.MaxMilliseconds = 0;
+		}
+
+		uint32 id;
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			CancelLocked();
+
+			//Zero means no search, so it's skipped when the ids wrap
+			LastId = LastId + 1 == 0 ? 1 : LastId + 1;
+			id = LastId;
+			request->Id = id;
+			request->Network = Network;
+			request->Position.SetNetwork(Network.get());
+			Pending = std::move(request);
+			Pondering = ponder;
+		}
+
+		Wake.notify_all();
+		return id;
+	}
+
+	bool EngineWorker::PonderHit(int64 maxMilliseconds)
+	{
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			if (!Pondering)
+			{
+				return false;
+			}
+
+			Pondering = false;
+			PonderHitPending = true;
+			PonderHitMilliseconds = maxMilliseconds;
+			PonderHitTime = std::chrono::steady_clock::now();
+			ApplyPonderHitLocked();
+		}
+
+		Wake.notify_all();
+		return true;
+	}
+
+	void EngineWorker::Stop()
+	{
+		//Remembered for the search queued or running, the searcher forgets a stop that comes before it starts
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			StopPending = Pending != nullptr || RunningId != 0;
+		}
+
+		Searcher.Stop();
+	}
+
+	void EngineWorker::Cancel()
+	{
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			CancelLocked();
+		}
+
+		Wake.notify_all();
+	}
+
+	bool EngineWorker::IsSearching() const
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		return RunningId != 0 || Pending != nullptr;
+	}
+
+	void EngineWorker::SetNetwork(std::shared_ptr<const Nnue::Network> network)
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		Network = std::move(network);
+	}
+
+	void EngineWorker::CancelLocked()
+	{
+		Pending.reset();
+		StopPending = false;
+		Pondering = false;
+		PonderHitPending = false;
+		CancelledId.store(LastId, std::memory_order_relaxed);
+		Searcher.Stop();
+	}
+
+	void EngineWorker::ApplyPonderHitLocked()
+	{
+		//Counted from the hit however late this is, so applying it again never gives the search longer
+		if (Pending != nullptr)
+		{
+			Pending->Limits.MaxMilliseconds = PonderHitMilliseconds;
+		}
+		else if (PonderHitMilliseconds > 0)
+		{
+			int64 elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - PonderHitTime).count();
+			Searcher.SetTimeLimit(std::max<int64>(PonderHitMilliseconds - elapsed, 1));
+		}
+		else
+		{
+			Searcher.SetTimeLimit(0);
+		}
+	}
+
+	void EngineWorker::WorkerLoop()
+	{
+		while (true)
+		{
+			std::unique_ptr<Request> request;
+			{
+				std::unique_lock<std::mutex> lock(Mutex);
+				Wake.wait(lock, [this]() { return ShuttingDown || Pending != nullptr; });
+				if (ShuttingDown)
+				{
+					return;
+				}
+
+				request = std::move(Pending);
+				RunningId = request->Id;
+			}
+
+			//A search only clears its stop flag and sets its time limit once it starts, so a stop, cancel or ponder hit landing
+			//between taking the request and starting it would be lost. The first iteration is over almost at once, it puts them right
+			uint32 id = request->Id;
+			Search::Result result = Searcher.Run(request->Position, request->Limits, [this, id](const Search::Result&)
+			{
+				if (id <= CancelledId.load(std::memory_order_relaxed))
+				{
+					Searcher.Stop();
+					return;
+				}
+
+				std::lock_guard<std::mutex> lock(Mutex);
+				if (StopPending)
+				{
+					Searcher.Stop();
+				}
+
+				if (PonderHitPending)
+				{
+					ApplyPonderHitLocked();
+					PonderHitPending = false;
+				}
+			});
+
+			bool cancelled;
+			{
+				//A ponder search that finishes before the opponent has moved holds on to its result until they have
+				std::unique_lock<std::mutex> lock(Mutex);
+				Wake.wait(lock, [this, id]() { return !Pondering || ShuttingDown || id <= CancelledId.load(std::memory_order_relaxed); });
+				RunningId = 0;
+				StopPending = false;
+				PonderHitPending = false;
+				cancelled = id <= CancelledId.load(std::memory_order_relaxed);
+			}
+
+			if (!cancelled && request->OnComplete)
+			{
+				request->OnComplete(id, result);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Board.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+namespace Chess
+{
+	/*
+		Runs searches on a background thread of its own so whoever asks never waits on one. Each search works on a snapshot of
+		the board taken when it's asked for, so the caller's board is free to change straight away. Only one search runs at a
+		time, asking for another cancels whatever was running or waiting. The worker thread and the table live as long as the
+		worker does, nothing is allocated per search past the snapshot.
+	*/
+	class EngineWorker
+	{
+	public:
+		//Called on the worker thread when a search finishes, with the id StartSearch gave it. Anything touching the caller's own
+		//state should be handed back to the caller's thread from here rather than done in the callback
+		typedef std::function<void(uint32 searchId, const Search::Result& result)> CompletionCallback;
+
+		EngineWorker(int32 hashMB, int32 threads);
+
+		//Cancels anything running and waits for the worker thread to finish
+		~EngineWorker();
+
+		EngineWorker(const EngineWorker&) = delete;
+		EngineWorker& operator=(const EngineWorker&) = delete;
+
+		//Queues a search of the board as it is now and returns its id, never zero. Cancels any search already running or queued.
+		//A ponder search is one of a position the opponent hasn't reached yet. It ignores any time limit and never completes
+		//until PonderHit says the opponent did play into it, holding on to its result if it finishes before then
+		uint32 StartSearch(const Board& board, const Search::Limits& limits, const CompletionCallback& onComplete, bool ponder = false);
+
+		//Turns the ponder search into an ordinary one with this long left to think, zero for no limit. The work it's already
+		//done counts. False if there's no ponder search to turn, it was cancelled or never started
+		bool PonderHit(int64 maxMilliseconds);
+
+		//Ends the running search early, it still completes with the best move found so far
+		void Stop();
+
+		//Ends the running search and drops any queued one, neither completes. A callback already under way when this is called
+		//can still finish, so a caller passing results between threads should check the id against the search it's waiting for
+		void Cancel();
+
+		bool IsSearching() const;
+
+		//Megabytes actually got for the table, which can be less than asked for when memory is short. 0 if there wasn't the
+		//memory for any table, the worker still searches but without one, so it plays far weaker
+		inline int32 GetHashMB() const { return Table.GetSizeMB(); }
+
+		//Searches started from now on evaluate with the network, or the hand written evaluation if it's null. Shared with
+		//every search using it, so replacing it never pulls it out from under one still running
+		void SetNetwork(std::shared_ptr<const Nnue::Network> network);
+
+	private:
+		struct Request
+		{
+			uint32 Id;
+			Board Position;
+			Search::Limits Limits;
+			CompletionCallback OnComplete;
+			std::shared_ptr<const Nnue::Network> Network;
+		};
+
+		void WorkerLoop();
+		void CancelLocked();
+		void ApplyPonderHitLocked();
+
+		TranspositionTable Table;
+		ParallelSearcher Searcher;
+
+		mutable std::mutex Mutex;
+		std::condition_variable Wake;
+		std::unique_ptr<Request> Pending;
+		uint32 RunningId;
+		uint32 LastId;
+		bool ShuttingDown;
+
+		//Stop was called for the search queued or running, applied once it's started
+		bool StopPending;
+		std::shared_ptr<const Nnue::Network> Network;
+
+		//Whether the latest search is a ponder search still waiting on PonderHit, and the time limit PonderHit gave it once it isn't
+		bool Pondering;
+		bool PonderHitPending;
+		int64 PonderHitMilliseconds;
+		std::chrono::steady_clock::time_point PonderHitTime;
+
+		//Every search with an id up to this one has been cancelled, read by the running search between iterations
+		std::atomic<uint32> CancelledId;
+
+		std::thread Worker;
+	};
+}
\ No newline at end of file
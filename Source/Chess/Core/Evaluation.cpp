@@ -0,0 +1,124 @@
+#include "Evaluation.h"
+
+#include "Attacks.h"
+#include "Bitboard.h"
+#include "PieceSquareTables.h"
+
+#include <algorithm>
+
+namespace Chess
+{
+	using namespace Constants;
+	using namespace PieceSquare;
+
+	namespace
+	{
+		//Pawn structure terms, from the point of view of the pawn's own side
+		const Score DoubledPawn = MakeScore(-10, -20);
+		const Score IsolatedPawn = MakeScore(-10, -15);
+		const Score BackwardPawn = MakeScore(-8, -10);
+
+		//Indexed by how far up the board the pawn is from its own side
+		const Score PassedPawn[8] =
+		{
+			MakeScore(0, 0), MakeScore(5, 10), MakeScore(10, 15), MakeScore(15, 25),
+			MakeScore(25, 45), MakeScore(45, 75), MakeScore(70, 120), MakeScore(0, 0),
+		};
+
+		//Own pawns on the king's file or either side of it, one and two ranks in front. Only worth having while there are
+		//pieces around to attack the king
+		const Score ShieldPawn[2] = { MakeScore(10, 0), MakeScore(5, 0) };
+
+		//Every square on or in front of the set, towards the given colour index's far side
+		inline uint64 FillForward(int8 colourIdx, uint64 squares)
+		{
+			if (colourIdx == 0)
+			{
+				squares |= squares << 8;
+				squares |= squares << 16;
+				return squares | (squares << 32);
+			}
+
+			squares |= squares >> 8;
+			squares |= squares >> 16;
+			return squares | (squares >> 32);
+		}
+
+		inline uint64 FillFiles(uint64 squares)
+		{
+			return FillForward(0, squares) | FillForward(1, squares);
+		}
+
+		//The squares either side of each in the set
+		inline uint64 Beside(uint64 squares)
+		{
+			return ((squares & ~Bitboard::FileA) >> 1) | ((squares & ~Bitboard::FileH) << 1);
+		}
+
+		inline uint64 PushPawns(int8 colourIdx, uint64 pawns)
+		{
+			return colourIdx == 0 ? pawns << 8 : pawns >> 8;
+		}
+
+		//Terms for one side's pawns, and the shelter they give its king
+		Score EvaluatePawnsFor(const State& state, int8 colourIdx, uint64& passed)
+		{
+			int8 colour = colourIdx == 0 ? Piece::White : Piece::Black;
+			uint64 pawns = state.PieceBitboards[Piece::Pawn] & state.ColourBitboards[colourIdx];
+			uint64 enemyPawns = state.PieceBitboards[Piece::Pawn] & state.ColourBitboards[colourIdx ^ 1];
+			uint64 pawnAttacks = Attacks::PawnSet(colourIdx, pawns);
+			uint64 enemyAttacks = Attacks::PawnSet(colourIdx ^ 1, enemyPawns);
+
+			//A pawn is passed when no enemy pawn stands in front of it or can capture it on its way up the board
+			uint64 enemySpan = FillForward(colourIdx ^ 1, PushPawns(colourIdx ^ 1, enemyPawns) | enemyAttacks);
+			passed = pawns & ~enemySpan;
+
+			//Anything with one of its own pawns behind it is the extra pawn on a doubled file
+			uint64 doubled = pawns & FillForward(colourIdx, PushPawns(colourIdx, pawns));
+			uint64 isolated = pawns & ~Beside(FillFiles(pawns));
+
+			//Backward pawns can't move up without being taken, and no pawn beside them can come up to defend them
+			uint64 backward = pawns & ~isolated & PushPawns(colourIdx ^ 1, enemyAttacks & ~FillForward(colourIdx, pawnAttacks));
+
+			Score score = Bitboard::PopCount(doubled) * DoubledPawn + Bitboard::PopCount(isolated) * IsolatedPawn +
+				Bitboard::PopCount(backward) * BackwardPawn;
+
+			uint64 walk = passed;
+			while (walk != Bitboard::Empty)
+			{
+				int8 square = Bitboard::PopLSB(walk);
+				int8 rank = Utils::RankIndex(square);
+				score += PassedPawn[colourIdx == 0 ? rank : 7 - rank];
+			}
+
+			int8 king = state.KingSquare(colour);
+			if (king != DEFAULT)
+			{
+				uint64 shield = PushPawns(colourIdx, Bitboard::SquareMask(king));
+				shield |= Beside(shield);
+				score += Bitboard::PopCount(pawns & shield) * ShieldPawn[0] + Bitboard::PopCount(pawns & PushPawns(colourIdx, shield)) * ShieldPawn[1];
+			}
+
+			return score;
+		}
+	}
+
+	int32 Evaluation::Evaluate(const State& state, PawnTable& pawns)
+	{
+		Score total = state.PieceSquareScore + pawns.Probe(state).Score;
+
+		//Promotions can take the phase past its starting value
+		int32 phase = std::min(static_cast<int32>(state.Phase), MaxPhase);
+		int32 score = (MidgameScore(total) * phase + EndgameScore(total) * (MaxPhase - phase)) / MaxPhase;
+
+		return state.ColourToMove == Piece::White ? score : -score;
+	}
+
+	void Evaluation::EvaluatePawns(const State& state, PawnEntry& entry)
+	{
+		uint64 whitePassed;
+		uint64 blackPassed;
+		entry.Score = EvaluatePawnsFor(state, 0, whitePassed) - EvaluatePawnsFor(state, 1, blackPassed);
+		entry.PassedPawns = whitePassed | blackPassed;
+	}
+}
\ No newline at end of file
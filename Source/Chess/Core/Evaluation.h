@@ -0,0 +1,25 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "PawnTable.h"
+#include "State.h"
+
+namespace Chess
+{
+	namespace Evaluation
+	{
+		//Centipawns, indexed by piece type. The king is never captured so it has no material value. Pawns gain on the
+		//minor pieces as the board empties and they get closer to promoting
+		const int32 PieceValues[7] = { 0, 0, 100, 320, 330, 500, 900 };
+		const int32 EndgamePieceValues[7] = { 0, 0, 120, 300, 320, 520, 940 };
+
+		//Score of the position for the side to move, positive when that side is ahead. State keeps the material and
+		//piece-square score up to date itself and the pawn terms come from the table, so this only has to add them up and
+		//blend the midgame and endgame halves by the phase
+		int32 Evaluate(const State& state, PawnTable& pawns);
+
+		//Works out the pawn structure and king shelter terms from scratch, only the pawn table should need to
+		void EvaluatePawns(const State& state, PawnEntry& entry);
+	}
+}
\ No newline at end of file
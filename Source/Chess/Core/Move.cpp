@@ -3,89 +3,107 @@
 #include "State.h"
 #include "MoveGeneration.h"
 
-#include <algorithm>
+#include <cctype>
 
 namespace Chess
 {
-	std::string Move::GenerateAlgebraicName(const State& board) const
+	std::string Move::ToString() const
 	{
-		if (Castle == Constants::Castling::Kingside)
+		std::string name = Utils::SquareName(StartSquare()) + Utils::SquareName(TargetSquare());
+		if (IsPromotion())
 		{
-			return "0-0";
+			name.append(1, static_cast<char>(std::tolower(Utils::AlgebraicName(Promote())[0])));
 		}
-		else if (Castle == Constants::Castling::Queenside)
+
+		return name;
+	}
+
+	std::string Move::GenerateAlgebraicName(const State& board) const
+	{
+		std::string move;
+		if (Castle() == Constants::Castling::Kingside)
 		{
-			return "0-0-0";
+			move = "0-0";
 		}
-		else if (Promote != Constants::Piece::None)
+		else if (Castle() == Constants::Castling::Queenside)
 		{
-			return Utils::SquareName(StartSquare) + "=" + Utils::AlgebraicName(Promote);
+			move = "0-0-0";
 		}
-
-		/*
-			We need to figure out if another piece of the same type can move to the same target square
-			Because if it can, we need to disambiguate the move. 
-			e.g if both rooks, one on g1 one on a2 can move to A1, we should have Rga1 or Raa1 so we know
-			which one moved
-		*/
-
-		int8 pieceToMove = board.Squares[StartSquare];
-		std::string move = Utils::AlgebraicName(pieceToMove);
-		
-		//We only need to do this if there are multiple pieces of the same type. So gather all pieces of that type on the board, remove the one that's making
-		//the move & skip if there's only one
-		std::vector<int8> piecesOfSameType = board.FindPiece(pieceToMove);
-		piecesOfSameType.erase(std::remove_if(piecesOfSameType.begin(), piecesOfSameType.end(), [pieceToMove](int8 piece) { return piece == pieceToMove; }));
-		if (piecesOfSameType.size() > 1)
+		else
 		{
-			//Now generate all of the valid moves for the other pieces
-			//TODO: I'm sure this can be done more efficiently
-			std::vector<Move> validMoves;
-			if (Utils::IsType(pieceToMove, Constants::Piece::Rook) || Utils::IsType(pieceToMove, Constants::Piece::Bishop))
+			int8 pieceToMove = board.Squares[StartSquare()];
+			if (Utils::IsType(pieceToMove, Constants::Piece::Pawn))
 			{
-				for (int8 piece : piecesOfSameType)
+				//Pawn captures are named by the file they came from
+				if (IsCapture())
 				{
-					MoveGeneration::GenerateSlidingMoves(board, piece, validMoves);
+					move.append(1, Utils::FileNames[Utils::FileIndex(StartSquare())]);
 				}
 			}
-			else if (Utils::IsType(pieceToMove, Constants::Piece::Knight))
+			else
 			{
-				for (int8 piece : piecesOfSameType)
+				move = Utils::AlgebraicName(pieceToMove);
+
+				/*
+					We need to figure out if another piece of the same type can move to the same target square
+					Because if it can, we need to disambiguate the move.
+					e.g if both rooks, one on g1 one on a2 can move to A1, we should have Rga1 or R2a1 so we know
+					which one moved
+				*/
+				MoveList legalMoves;
+				MoveGeneration::GenerateMoves(board, board.ColourToMove, legalMoves);
+
+				bool ambiguous = false;
+				bool sharesFile = false;
+				bool sharesRank = false;
+				for (const Move& alternateMove : legalMoves)
 				{
-					MoveGeneration::GenerateKnightMoves(board, piece, validMoves);
+					int8 alternateStart = alternateMove.StartSquare();
+					if (alternateMove.TargetSquare() == TargetSquare() && alternateStart != StartSquare() && board.Squares[alternateStart] == pieceToMove)
+					{
+						ambiguous = true;
+						sharesFile |= Utils::FileIndex(alternateStart) == Utils::FileIndex(StartSquare());
+						sharesRank |= Utils::RankIndex(alternateStart) == Utils::RankIndex(StartSquare());
+					}
 				}
-			}
-			else if (Utils::IsType(pieceToMove, Constants::Piece::Pawn))
-			{
-				for (int8 piece : piecesOfSameType)
+
+				if (ambiguous)
 				{
-					MoveGeneration::GeneratePawnMoves(board, piece, validMoves);
-					MoveGeneration::GeneratePawnAttacks(board, piece, validMoves);
+					if (!sharesFile)
+					{
+						move.append(1, Utils::FileNames[Utils::FileIndex(StartSquare())]);
+					}
+					else if (!sharesRank)
+					{
+						move.append(1, Utils::RankNames[Utils::RankIndex(StartSquare())]);
+					}
+					else
+					{
+						move += Utils::SquareName(StartSquare());
+					}
 				}
 			}
 
-			//Loop over all of those moves, if any have the same target, voila, ambiguity to be resolved
-			for (Move& alternateMove : validMoves)
+			if (IsCapture())
 			{
-				if (alternateMove.TargetSquare == TargetSquare)
-				{
-					move += Utils::SquareName(StartSquare);
-					break;
-				}
+				move += "x";
 			}
-		}
 
-		if (board.Squares[TargetSquare] != Constants::Piece::None)
-		{
-			move += "x";
-		}
+			move += Utils::SquareName(TargetSquare());
 
-		move += Utils::SquareName(TargetSquare);
+			if (IsPromotion())
+			{
+				move += "=" + Utils::AlgebraicName(Promote());
+			}
+		}
 
-		if (board.IsKingThreatened(Utils::IsColour(Colour, Constants::Piece::White) ? Constants::Piece::Black : Constants::Piece::White))
+		State afterMove(board);
+		afterMove.Update(*this);
+		if (afterMove.IsKingThreatened(afterMove.ColourToMove))
 		{
-			//TODO: Determine checkmate
-			move += "+";
+			MoveList replies;
+			MoveGeneration::GenerateMoves(afterMove, afterMove.ColourToMove, replies);
+			move += replies.IsEmpty() ? "#" : "+";
 		}
 
 		return move;
@@ -9,96 +9,137 @@ namespace Chess
 {
 	struct State;
 
+	/*
+		A move packed into 16 bits: start square in bits 0-5, target square in bits 6-11 and a MoveFlag in bits 12-15.
+		Everything else a move does to the board (the castling rook, the pawn taken en passent, the en passent square
+		it creates, the castling rights it removes) is derived from those when the move is applied.
+	*/
 	struct Move
 	{
 	public:
-		int8 StartSquare;
-		int8 TargetSquare;
-
-		int8 SecondaryStart;
-		int8 SecondaryTarget;
-
-		int8 Colour;
-
-		int8 EnPassentTarget;
-
-		int8 PreventsCastling;
-		int8 Castle;
-
-		int8 Promote;
+		Move() : Data(0) {}
 
 		//Regular move/capture
-		static Move CreateMove(const State& board, int8 Start, int8 Target, int8 PlayerColour, int8 PreventsCastling = Constants::Castling::None)
+		static Move CreateMove(int8 Start, int8 Target, uint8 flag = Constants::MoveFlag::Quiet)
 		{
-			return Move(board, Start, Target, Constants::DEFAULT, Constants::DEFAULT, PlayerColour, Constants::DEFAULT, PreventsCastling);
+			return Move(Start, Target, flag);
 		}
 
 		//Pawn move that allows en passent
-		static Move CreateEnPassentMove(const State& board, int8 Start, int8 Target, int8 PlayerColour)
+		static Move CreateEnPassentMove(int8 Start, int8 Target)
 		{
-			return Move(board, Start, Target, Constants::DEFAULT, Constants::DEFAULT, PlayerColour, Start + (PlayerColour == Constants::Piece::White ? 8 : -8));
+			return Move(Start, Target, Constants::MoveFlag::DoublePawnPush);
 		}
 
 		//Pawn capturing en passent
-		static Move CreateEnPassentCapture(const State& board, int8 Start, int8 Target, int8 PlayerColour, int8 passentPawn, int8 passentTarget)
+		static Move CreateEnPassentCapture(int8 Start, int8 Target)
 		{
-			return Move(board, Start, Target, passentPawn, Constants::DEFAULT, PlayerColour, passentTarget);
+			return Move(Start, Target, Constants::MoveFlag::EnPassentCapture);
 		}
 
 		//Pawn promotion
-		static Move CreatePromotionMove(const State& board, int8 Start, int8 Target, int8 PlayerColour, int8 promote)
+		static Move CreatePromotionMove(int8 Start, int8 Target, int8 promote, bool capture = false)
 		{
-			return Move(board, Start, Target, Constants::DEFAULT, Constants::DEFAULT, PlayerColour, Constants::DEFAULT, Constants::Castling::None, Constants::Castling::None, promote);
+			using namespace Constants;
+
+			//Promotion pieces are consecutive from knight to queen, so the low two bits of the flag are the offset from knight
+			uint8 flag = MoveFlag::Promotion | (capture ? MoveFlag::Capture : MoveFlag::Quiet) | (promote - Piece::Knight);
+			return Move(Start, Target, flag);
 		}
 
 		//Castling
-		static Move CreateCastlingMove(const State& board, int8 PlayerColour, int8 castle)
+		static Move CreateCastlingMove(int8 PlayerColour, int8 castle)
 		{
 			using namespace Constants;
 
 			int8 Start = PlayerColour == Piece::White ? 4 : 60;
-			int8 Target = -1;
 			if (castle == Castling::Kingside)
 			{
-				Target = PlayerColour == Piece::White ? 6 : 62;
+				return Move(Start, Start + 2, MoveFlag::KingsideCastle);
 			}
-			else if (castle == Castling::Queenside)
+
+			return Move(Start, Start - 2, MoveFlag::QueensideCastle);
+		}
+
+		//Rebuilds a move packed with GetData, for tables that store moves as plain integers
+		static Move FromData(uint16 data)
+		{
+			Move move;
+			move.Data = data;
+			return move;
+		}
+
+		inline int8 StartSquare() const { return Data & 0x3F; }
+		inline int8 TargetSquare() const { return (Data >> 6) & 0x3F; }
+		inline uint8 Flags() const { return Data >> 12; }
+		inline uint16 GetData() const { return Data; }
+		inline bool IsNull() const { return Data == 0; }
+
+		inline bool IsCapture() const { return (Flags() & Constants::MoveFlag::Capture) != 0; }
+		inline bool IsPromotion() const { return (Flags() & Constants::MoveFlag::Promotion) != 0; }
+		inline bool IsEnPassentCapture() const { return Flags() == Constants::MoveFlag::EnPassentCapture; }
+		inline bool IsDoublePawnPush() const { return Flags() == Constants::MoveFlag::DoublePawnPush; }
+
+		inline int8 Castle() const
+		{
+			using namespace Constants;
+			return Flags() == MoveFlag::KingsideCastle ? Castling::Kingside : Flags() == MoveFlag::QueensideCastle ? Castling::Queenside : Castling::None;
+		}
+
+		inline int8 Promote() const
+		{
+			return IsPromotion() ? Constants::Piece::Knight + (Flags() & 0x3) : Constants::Piece::None;
+		}
+
+		//The rook moved by castling, or the pawn taken en passent
+		inline int8 SecondaryStart() const
+		{
+			if (IsEnPassentCapture())
 			{
-				Target = PlayerColour == Piece::White ? 2 : 58;
+				return (StartSquare() & ~0x7) | (TargetSquare() & 0x7);
 			}
 
-			int8 secondaryStart, secondaryTarget;
-			//Handle rook, king has already moved
-			if ((PlayerColour & Piece::White) == Piece::White)
+			int8 castle = Castle();
+			if (castle == Constants::Castling::Kingside)
 			{
-				secondaryStart = castle == Castling::Queenside ? 0 : 7;
-				secondaryTarget = castle == Castling::Queenside ? 3 : 5;
+				return StartSquare() + 3;
 			}
-			else
+			else if (castle == Constants::Castling::Queenside)
 			{
-				secondaryStart = castle == Castling::Queenside ? 56 : 63;
-				secondaryTarget = castle == Castling::Queenside ? 59 : 61;
+				return StartSquare() - 4;
 			}
 
-			return Move(board, Start, Target, secondaryStart, secondaryTarget, PlayerColour, Constants::DEFAULT, Castling::Both, castle);
+			return Constants::DEFAULT;
+		}
+
+		//Where the castling rook ends up. DEFAULT for everything else, including en passent where the secondary piece is just removed
+		inline int8 SecondaryTarget() const
+		{
+			return Castle() != Constants::Castling::None ? (StartSquare() + TargetSquare()) / 2 : Constants::DEFAULT;
 		}
 
-		std::string ToString() const { return AlgebraicName; }
+		//The square skipped over by a double pawn push
+		inline int8 EnPassentTarget() const
+		{
+			return IsDoublePawnPush() ? (StartSquare() + TargetSquare()) / 2 : Constants::NO_EN_PASSENT;
+		}
+
+		//Coordinate notation, e.g. e2e4 or e7e8q
+		std::string ToString() const;
+
+		//Standard algebraic notation, the board must be the position before the move is made
+		std::string GenerateAlgebraicName(const State& board) const;
+
 	private:
-		Move(const State& board, int8 start = Constants::DEFAULT, int8 target = Constants::DEFAULT, int8 secondaryStart = Constants::DEFAULT, int8 secondaryTarget = Constants::DEFAULT,
-			int8 colour = Constants::DEFAULT, int8 enPassent = Constants::NO_EN_PASSENT, int8 preventCastle = Constants::Castling::None, int8 castle = Constants::Castling::None, int8 promotion = Constants::Piece::None) :
-			StartSquare(start), TargetSquare(target),
-			SecondaryStart(secondaryStart), SecondaryTarget(secondaryTarget),
-			Colour(colour),
-			EnPassentTarget(enPassent),
-			PreventsCastling(preventCastle), Castle(castle),
-			Promote(promotion), AlgebraicName(/*GenerateAlgebraicName(board)*/) //TODO: Re-add move naming in a way that isn't recursive
+		Move(int8 start, int8 target, uint8 flag) :
+			Data(static_cast<uint16>(start | (target << 6) | (flag << 12)))
 		{ }
 
-		std::string GenerateAlgebraicName(const State& board) const;
-		std::string AlgebraicName;
+		uint16 Data;
 	};
 
-	inline bool operator==(const Move& lhs, const Move& rhs) { return lhs.StartSquare == rhs.StartSquare && lhs.TargetSquare == rhs.TargetSquare && lhs.Colour == rhs.Colour; }
+	static_assert(sizeof(Move) == 2, "Moves should pack into 16 bits");
+
+	inline bool operator==(const Move& lhs, const Move& rhs) { return lhs.GetData() == rhs.GetData(); }
 	inline bool operator!=(const Move& lhs, const Move& rhs) { return !operator==(lhs, rhs); }
 }
\ No newline at end of file
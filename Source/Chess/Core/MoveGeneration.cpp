@@ -1,309 +1,440 @@
 #include "MoveGeneration.h"
 
+#include "Attacks.h"
 #include "Utils.h"
 
-#include <assert.h>
-
 namespace Chess
 {
 	using namespace Constants;
+	using MoveGeneration::KingSafety;
+	using MoveGeneration::GenerationType::Captures;
+	using MoveGeneration::GenerationType::Quiets;
 
-	std::vector<Move> MoveGeneration::GenerateMoves(const State& board, int8 colour, bool calculateThreat /*= false*/)
+	namespace
 	{
-		//TODO: This is really slow. Fix
-		std::vector<Move> moves = GenerateMoves_Impl(board, colour, calculateThreat);
-		if (!calculateThreat)
+		/*
+			Everything about a side that the generators would otherwise work out from the colour at runtime. The generators are
+			templated on the colour so all of this folds into constants, and GenerateMoves picks the instantiation once per call.
+		*/
+		template<int8 Colour>
+		struct Side
 		{
-			PruneIllegalMoves_Impl(board, colour, moves);
-		}
+			static constexpr bool IsWhite = Colour == Piece::White;
+			static constexpr int8 Index = IsWhite ? 0 : 1;
+
+			//Square offsets for a step forward and for captures towards the a and h files
+			static constexpr int8 Forward = IsWhite ? 8 : -8;
+			static constexpr int8 CaptureWest = IsWhite ? 7 : -9;
+			static constexpr int8 CaptureEast = IsWhite ? 9 : -7;
+
+			//Rank a single push lands on when the pawn can go again, and the rank a pawn promotes on
+			static constexpr uint64 DoublePushRank = IsWhite ? Bitboard::Rank1 << 16 : Bitboard::Rank1 << 40;
+			static constexpr uint64 PromotionRank = IsWhite ? Bitboard::Rank8 : Bitboard::Rank1;
+
+			//Castling squares are given for white and shifted up to the eighth rank for black
+			static constexpr int8 BackRank = IsWhite ? 0 : 56;
+			static constexpr uint64 KingsideEmpty = 0x60ULL << BackRank;
+			static constexpr uint64 QueensideEmpty = 0x0EULL << BackRank;
+			static constexpr uint64 QueensideSafe = 0x0CULL << BackRank;
+		};
 
-		return moves;
-	}
+		template<int8 Offset>
+		inline uint64 Shift(uint64 bitboard)
+		{
+			return Offset > 0 ? bitboard << Offset : bitboard >> -Offset;
+		}
 
-	void MoveGeneration::PruneIllegalMoves_Impl(const State& board, int8 colour, std::vector<Move>& moves)
-	{
-		for (int idx = moves.size() - 1; idx >= 0; idx--)
+		//Cut a piece's targets down to the ones that don't leave the king in check
+		inline uint64 LegalTargets(const KingSafety& safety, int8 startSquare, uint64 targets)
 		{
-			if (board.DoesMoveExposeKing(moves[idx]))
+			targets &= safety.CheckMask;
+			if (Bitboard::Contains(safety.Pinned, startSquare))
 			{
-				moves.erase(moves.begin() + idx);
+				targets &= Attacks::Line(safety.KingSquare, startSquare);
 			}
+
+			return targets;
 		}
-	}
 
-	void MoveGeneration::GenerateSlidingMoves(const State& state, int8 startSquare, std::vector<Move>& moves)
-	{
-		int8 piece = state.Squares[startSquare];
-		int8 friendlyColour = Utils::GetColour(piece);
-		int8 enemyColour = friendlyColour == Piece::White ? Piece::Black : Piece::White;
+		//Squares a piece may move to for the type being generated, before legality
+		template<int8 Colour, uint8 Type>
+		inline uint64 TargetMask(const State& state)
+		{
+			uint64 mask = Bitboard::Empty;
+			if (Type & Captures)
+			{
+				mask |= state.ColourBitboards[Side<Colour>::Index ^ 1];
+			}
 
-		bool isRook = Utils::IsType(piece, Piece::Rook);
-		int8 startDirIdx = Utils::IsType(piece, Piece::Bishop) ? 4 : 0;
-		int8 endDirIdx = isRook ? 4 : 8;
+			if (Type & Quiets)
+			{
+				mask |= ~state.Occupancy;
+			}
+
+			return mask;
+		}
 
-		for (int8 directionIndex = startDirIdx; directionIndex < endDirIdx; directionIndex++)
+		//Captures and quiet moves are split by set rather than by looking at each target square
+		inline void AddMoves(const State& state, MoveList& moves, int8 startSquare, uint64 targets)
 		{
-			for (int8 n = 0; n < NumSquaresToEdge[startSquare][directionIndex]; n++)
+			uint64 captures = targets & state.Occupancy;
+			while (captures != Bitboard::Empty)
 			{
-				int8 targetSquare = startSquare + DirectionOffsets[directionIndex] * (n + 1);
-				int8 pieceOnTargetSquare = state.Squares[targetSquare];
+				moves.Add(Move::CreateMove(startSquare, Bitboard::PopLSB(captures), MoveFlag::Capture));
+			}
 
-				if (Utils::IsColour(pieceOnTargetSquare, friendlyColour))
-				{
-					break;
-				}
+			uint64 quiets = targets & ~state.Occupancy;
+			while (quiets != Bitboard::Empty)
+			{
+				moves.Add(Move::CreateMove(startSquare, Bitboard::PopLSB(quiets), MoveFlag::Quiet));
+			}
+		}
 
-				if (isRook)
-				{
-					int8 prevented = Utils::RankIndex(0) ? Castling::Queenside : Castling::Kingside;
-					moves.push_back(Move::CreateMove(state, startSquare, targetSquare, friendlyColour, prevented));
-				}
-				else
-				{
-					moves.push_back(Move::CreateMove(state, startSquare, targetSquare, friendlyColour));
-				}
+		//Every pawn in targets moved by Offset squares, Offset being the step from start to target
+		template<int8 Offset>
+		inline void AddPawnMoves(MoveList& moves, uint64 targets, uint8 flag)
+		{
+			while (targets != Bitboard::Empty)
+			{
+				int8 targetSquare = Bitboard::PopLSB(targets);
+				moves.Add(Move::CreateMove(targetSquare - Offset, targetSquare, flag));
+			}
+		}
 
-				if (Utils::IsColour(pieceOnTargetSquare, enemyColour))
+		template<int8 Offset>
+		inline void AddPromotions(MoveList& moves, uint64 targets, bool capture)
+		{
+			while (targets != Bitboard::Empty)
+			{
+				int8 targetSquare = Bitboard::PopLSB(targets);
+				for (int8 promo : Constants::Promotions)
 				{
-					break;
+					moves.Add(Move::CreatePromotionMove(targetSquare - Offset, targetSquare, promo, capture));
 				}
 			}
 		}
-	}
 
-	void MoveGeneration::GenerateKnightMoves(const State& state, int8 startSquare, std::vector<Move>& moves)
-	{
-		const int8 KnightOffsets[8] = { 15, 17, -17, -15, 10, -6, 6, -10 };
+		template<int8 Colour>
+		KingSafety CalculateKingSafety(const State& board)
+		{
+			typedef Side<Colour> Us;
 
-		int8 piece = state.Squares[startSquare];
-		int8 friendlyColour = Utils::GetColour(piece);
-		int8 enemyColour = friendlyColour == Piece::White ? Piece::Black : Piece::White;
+			uint64 friendly = board.ColourBitboards[Us::Index];
+			uint64 enemies = board.ColourBitboards[Us::Index ^ 1];
+			uint64 rooks = (board.PieceBitboards[Piece::Rook] | board.PieceBitboards[Piece::Queen]) & enemies;
+			uint64 bishops = (board.PieceBitboards[Piece::Bishop] | board.PieceBitboards[Piece::Queen]) & enemies;
 
-		for (int knightMoveIdx = 0; knightMoveIdx < 8; knightMoveIdx++)
-		{
-			int8 targetSquare = startSquare + KnightOffsets[knightMoveIdx];
-			if (targetSquare < 0 || targetSquare >= 64)
+			KingSafety safety;
+			safety.KingSquare = board.KingSquares[Us::Index];
+			safety.Checkers = MoveGeneration::AttackersTo(board, safety.KingSquare, board.Occupancy) & enemies;
+			safety.Pinned = Bitboard::Empty;
+
+			//Any slider that would see the king on an empty board pins the piece in between, if there's exactly one
+			uint64 snipers = (Attacks::Rook(safety.KingSquare, Bitboard::Empty) & rooks) | (Attacks::Bishop(safety.KingSquare, Bitboard::Empty) & bishops);
+			while (snipers != Bitboard::Empty)
 			{
-				continue;
+				uint64 blockers = Attacks::Between(safety.KingSquare, Bitboard::PopLSB(snipers)) & board.Occupancy;
+				if (Bitboard::PopCount(blockers) == 1)
+				{
+					safety.Pinned |= blockers & friendly;
+				}
 			}
 
-			//Reject jumps that wrap around the edge of the board
-			int8 y = startSquare / 8;
-			int8 x = startSquare - y * 8;
-
-			int8 targetY = targetSquare / 8;
-			int8 targetX = targetSquare - targetY * 8;
-			//If you've moved further than 2 on x/y (when coords are 0-8) you've wrapped the board
-			if (std::max(std::abs(x - targetX), std::abs(y - targetY)) != 2)
+			switch (Bitboard::PopCount(safety.Checkers))
 			{
-				continue;
+			case 0:
+				safety.CheckMask = ~Bitboard::Empty;
+				break;
+			case 1:
+				safety.CheckMask = safety.Checkers | Attacks::Between(safety.KingSquare, Bitboard::LSB(safety.Checkers));
+				break;
+			default:
+				safety.CheckMask = Bitboard::Empty;
+				break;
 			}
 
-			if (Utils::IsColour(state.Squares[targetSquare], friendlyColour))
+			//The threat maps are built with the king on the board, so the squares behind it along a checking slider's line look safe when they aren't
+			const ThreatMap& threats = Us::IsWhite ? board.BlackThreatMap : board.WhiteThreatMap;
+			safety.KingDanger = static_cast<uint64>(threats.GetMap());
+
+			uint64 slidingCheckers = safety.Checkers & (rooks | bishops);
+			while (slidingCheckers != Bitboard::Empty)
 			{
-				continue;
+				int8 checker = Bitboard::PopLSB(slidingCheckers);
+				safety.KingDanger |= Attacks::Line(checker, safety.KingSquare) & ~Bitboard::SquareMask(checker);
 			}
 
-			moves.push_back(Move::CreateMove(state, startSquare, targetSquare, friendlyColour));
+			return safety;
 		}
-	}
 
-	void MoveGeneration::GeneratePawnMoves(const State& state, int8 startSquare, std::vector<Move>& moves)
-	{
-		const int8 PawnOffsets[2][2]
+		//Pushes and captures for a set of pawns that may all move to any square in allowed, a whole set at a time
+		template<int8 Colour, uint8 Type>
+		void GeneratePawnMoves(const State& state, uint64 pawns, uint64 allowed, MoveList& moves)
 		{
-			{ 8, 16 }, //White
-			{-8, -16}  //Black
-		};
+			typedef Side<Colour> Us;
 
-		int8 piece = state.Squares[startSquare];
-		int8 colour = Utils::GetColour(piece);
-		int8 colourIdx = Utils::IsColour(piece, Piece::White) ? 0 : 1;
-		int8 startingRank = Utils::IsColour(piece, Piece::White) ? 1 : 6;
-		int8 backRank = Utils::IsColour(piece, Piece::White) ? 7 : 0;
-		int MovesAvailable = Utils::RankIndex(startSquare) == startingRank ? 2 : 1;
+			if (Type & Quiets)
+			{
+				uint64 empty = ~state.Occupancy;
+				uint64 singlePushes = Shift<Us::Forward>(pawns) & empty;
+				uint64 doublePushes = Shift<Us::Forward>(singlePushes & Us::DoublePushRank) & empty & allowed;
+
+				AddPawnMoves<Us::Forward>(moves, singlePushes & allowed & ~Us::PromotionRank, MoveFlag::Quiet);
+				AddPawnMoves<Us::Forward * 2>(moves, doublePushes, MoveFlag::DoublePawnPush);
+			}
 
-		for (int moveIdx = 0; moveIdx < MovesAvailable; moveIdx++)
+			if (Type & Captures)
+			{
+				uint64 enemies = state.ColourBitboards[Us::Index ^ 1] & allowed;
+				uint64 westCaptures = Shift<Us::CaptureWest>(pawns & ~Bitboard::FileA) & enemies;
+				uint64 eastCaptures = Shift<Us::CaptureEast>(pawns & ~Bitboard::FileH) & enemies;
+				uint64 promotions = Shift<Us::Forward>(pawns) & ~state.Occupancy & allowed & Us::PromotionRank;
+
+				AddPawnMoves<Us::CaptureWest>(moves, westCaptures & ~Us::PromotionRank, MoveFlag::Capture);
+				AddPawnMoves<Us::CaptureEast>(moves, eastCaptures & ~Us::PromotionRank, MoveFlag::Capture);
+				AddPromotions<Us::Forward>(moves, promotions, false);
+				AddPromotions<Us::CaptureWest>(moves, westCaptures & Us::PromotionRank, true);
+				AddPromotions<Us::CaptureEast>(moves, eastCaptures & Us::PromotionRank, true);
+			}
+		}
+
+		template<int8 Colour>
+		void GenerateEnPassent(const State& state, uint64 movers, MoveList& moves, const KingSafety& safety)
 		{
-			int8 targetSquare = startSquare + PawnOffsets[colourIdx][moveIdx];
-			if (state.Squares[targetSquare] != Piece::None)
+			typedef Side<Colour> Us;
+
+			if (state.EnPassentTarget == NO_EN_PASSENT)
 			{
-				break;
+				return;
 			}
 
-			if (Utils::RankIndex(targetSquare) == backRank)
+			//The pawn being taken sits behind the en passent square. Taking it either has to resolve a check, or there must be no check
+			int8 passentPawn = state.EnPassentTarget - Us::Forward;
+			if (!Bitboard::Contains(safety.CheckMask, state.EnPassentTarget) && !Bitboard::Contains(safety.CheckMask, passentPawn))
 			{
-				for (int8 promo : Constants::Promotions)
-				{
-					moves.push_back(Move::CreatePromotionMove(state, startSquare, targetSquare, colour, promo));
-				}
+				return;
 			}
-			else
+
+			uint64 enemies = state.ColourBitboards[Us::Index ^ 1];
+			uint64 rooks = (state.PieceBitboards[Piece::Rook] | state.PieceBitboards[Piece::Queen]) & enemies;
+			uint64 bishops = (state.PieceBitboards[Piece::Bishop] | state.PieceBitboards[Piece::Queen]) & enemies;
+
+			//A pawn of ours could take en passent from wherever an enemy pawn on the en passent square would attack
+			uint64 capturers = Attacks::Pawn(Us::Index ^ 1, state.EnPassentTarget) & state.PieceBitboards[Piece::Pawn] & movers;
+			while (capturers != Bitboard::Empty)
 			{
-				if (moveIdx == 1)
-				{
-					moves.push_back(Move::CreateEnPassentMove(state, startSquare, targetSquare, colour));
-				}
-				else
+				int8 startSquare = Bitboard::PopLSB(capturers);
+
+				//Two pawns leave the rank at once so pins can't be checked the usual way, just look for a slider on the king once both have moved
+				uint64 occupancy = (state.Occupancy ^ Bitboard::SquareMask(startSquare) ^ Bitboard::SquareMask(passentPawn)) | Bitboard::SquareMask(state.EnPassentTarget);
+				if ((Attacks::Rook(safety.KingSquare, occupancy) & rooks) == Bitboard::Empty && (Attacks::Bishop(safety.KingSquare, occupancy) & bishops) == Bitboard::Empty)
 				{
-					moves.push_back(Move::CreateMove(state, startSquare, targetSquare, colour));
+					moves.Add(Move::CreateEnPassentCapture(startSquare, state.EnPassentTarget));
 				}
 			}
 		}
-	}
 
-	void MoveGeneration::GeneratePawnAttacks(const State& state, int8 startSquare, std::vector<Move>& moves, bool calculateThreat)
-	{
-		const int8 PawnOffsets[2][3]
+		//Moves for every piece other than the king in movers, which must all be the moving side's
+		template<int8 Colour, uint8 Type>
+		void GeneratePieceMoves(const State& state, uint64 movers, MoveList& moves, const KingSafety& safety)
 		{
-			{ 7, 9 , 8}, //White
-			{ -9, -7, -8 } //Black
-		};
+			uint64 targetMask = TargetMask<Colour, Type>(state) & safety.CheckMask;
+
+			//A pinned knight can never stay on the line it's pinned along
+			uint64 knights = state.PieceBitboards[Piece::Knight] & movers & ~safety.Pinned;
+			while (knights != Bitboard::Empty)
+			{
+				int8 startSquare = Bitboard::PopLSB(knights);
+				AddMoves(state, moves, startSquare, Attacks::Knight(startSquare) & targetMask);
+			}
 
-		int8 piece = state.Squares[startSquare];
-		int8 colour = Utils::GetColour(piece);
-		int8 colourIdx = Utils::IsColour(piece, Piece::White) ? 0 : 1;
-		int8 enemyColour = Utils::IsColour(piece, Piece::White) ? Piece::Black : Piece::White;
-		int8 file = Utils::FileIndex(startSquare);
+			//Queens are walked as both, one lookup each way is no more work than a combined lookup
+			uint64 bishops = (state.PieceBitboards[Piece::Bishop] | state.PieceBitboards[Piece::Queen]) & movers;
+			while (bishops != Bitboard::Empty)
+			{
+				int8 startSquare = Bitboard::PopLSB(bishops);
+				AddMoves(state, moves, startSquare, LegalTargets(safety, startSquare, Attacks::Bishop(startSquare, state.Occupancy) & targetMask));
+			}
 
-		for (int moveIdx = 0; moveIdx < 2; moveIdx++)
-		{
-			//Make sure pawns on the 0th file can't attack left & the 7th can't attack right
-			if ((file == 0 && moveIdx == 0) || file == 7 && moveIdx == 1)
+			uint64 rooks = (state.PieceBitboards[Piece::Rook] | state.PieceBitboards[Piece::Queen]) & movers;
+			while (rooks != Bitboard::Empty)
 			{
-				continue;
+				int8 startSquare = Bitboard::PopLSB(rooks);
+				AddMoves(state, moves, startSquare, LegalTargets(safety, startSquare, Attacks::Rook(startSquare, state.Occupancy) & targetMask));
 			}
 
-			int8 targetSquare = startSquare + PawnOffsets[colourIdx][moveIdx];
+			//Pinned pawns can only move along their pin, which is rare enough to do one at a time
+			uint64 pawns = state.PieceBitboards[Piece::Pawn] & movers;
+			GeneratePawnMoves<Colour, Type>(state, pawns & ~safety.Pinned, safety.CheckMask, moves);
 
-			int8 passentPawn = state.EnPassentTarget + PawnOffsets[colourIdx == 0 ? 1 : 0][2];
-			if (state.EnPassentTarget == targetSquare && Utils::IsColour(state.Squares[passentPawn], enemyColour))
+			uint64 pinnedPawns = pawns & safety.Pinned;
+			while (pinnedPawns != Bitboard::Empty)
 			{
-				moves.push_back(Move::CreateEnPassentCapture(state, startSquare, targetSquare, colour, passentPawn, state.EnPassentTarget));
-				continue;
+				int8 startSquare = Bitboard::PopLSB(pinnedPawns);
+				GeneratePawnMoves<Colour, Type>(state, Bitboard::SquareMask(startSquare), safety.CheckMask & Attacks::Line(safety.KingSquare, startSquare), moves);
 			}
 
-			if (calculateThreat || Utils::IsColour(state.Squares[targetSquare], enemyColour))
+			if (Type & Captures)
 			{
-				moves.push_back(Move::CreateMove(state, startSquare, targetSquare, colour));
+				GenerateEnPassent<Colour>(state, movers, moves, safety);
 			}
 		}
-	}
-
-	void MoveGeneration::GenerateKingMoves(const State& state, int8 startSquare, std::vector<Move>& moves, bool calculateThreat /* = false*/)
-	{
-		int8 piece = state.Squares[startSquare];
-		int8 friendlyColour = Utils::GetColour(piece);
-		int8 enemyColour = friendlyColour == Piece::White ? Piece::Black : Piece::White;
 
-		for (int8 directionIndex = 0; directionIndex < 8; directionIndex++)
+		template<int8 Colour, uint8 Type>
+		void GenerateKingMoves(const State& state, MoveList& moves, const KingSafety& safety)
 		{
-			int8 targetSquare = startSquare + DirectionOffsets[directionIndex];
-			int8 pieceOnTargetSquare = state.Squares[targetSquare];
+			typedef Side<Colour> Us;
+
+			AddMoves(state, moves, safety.KingSquare, Attacks::King(safety.KingSquare) & TargetMask<Colour, Type>(state) & ~safety.KingDanger);
 
-			if (targetSquare < 0 || targetSquare >= 64)
+			//Can't castle out of check
+			if (!(Type & Quiets) || safety.Checkers != Bitboard::Empty)
 			{
-				continue;
+				return;
 			}
 
-			if (Utils::IsColour(pieceOnTargetSquare, friendlyColour))
+			uint64 rooks = state.PieceBitboards[Piece::Rook] & state.ColourBitboards[Us::Index];
+			int8 castleAvailability = Us::IsWhite ? state.WhiteCastleAvailable : state.BlackCastleAvailable;
+
+			//Everything between king and rook has to be empty, and the king can't pass through or land on an attacked square
+			if ((castleAvailability & Castling::Kingside) == Castling::Kingside && Bitboard::Contains(rooks, Us::BackRank + 7) &&
+				(state.Occupancy & Us::KingsideEmpty) == Bitboard::Empty && (safety.KingDanger & Us::KingsideEmpty) == Bitboard::Empty)
 			{
-				continue;
+				moves.Add(Move::CreateCastlingMove(Colour, Castling::Kingside));
 			}
 
-			if (!state.IsSquareThreatened(targetSquare, friendlyColour))
+			if ((castleAvailability & Castling::Queenside) == Castling::Queenside && Bitboard::Contains(rooks, Us::BackRank) &&
+				(state.Occupancy & Us::QueensideEmpty) == Bitboard::Empty && (safety.KingDanger & Us::QueensideSafe) == Bitboard::Empty)
 			{
-				moves.push_back(Move::CreateMove(state, startSquare, targetSquare, friendlyColour, Castling::Kingside | Castling::Queenside));
+				moves.Add(Move::CreateCastlingMove(Colour, Castling::Queenside));
 			}
 		}
 
-		//Castling doesn't generate threat on it's own, i.e. it's not an implicitly attacking move
-		//The threat comes from the subsequent position of the pieces so it can be ignored for this purpose
-		if (!calculateThreat)
+		template<int8 Colour, uint8 Type>
+		void GenerateMoves(const State& board, const KingSafety& safety, MoveList& moves)
 		{
-			int8 castleAvailability = friendlyColour == Piece::White ? state.WhiteCastleAvailable : state.BlackCastleAvailable;
-			if ((castleAvailability & Castling::Kingside) == Castling::Kingside)
-			{
-				int8 startIdx = friendlyColour == Piece::White ? 5 : 61;
-				int8 endIdx = friendlyColour == Piece::White ? 6 : 62;
-				bool castlingBlocked = false;
-				for (int idx = startIdx; idx < endIdx; idx++)
-				{
-					if (state.Squares[idx] != Piece::None || state.IsSquareThreatened(idx, friendlyColour))
-					{
-						castlingBlocked = true;
-						break;
-					}
-				}
+			moves.Clear();
+			GenerateKingMoves<Colour, Type>(board, moves, safety);
 
-				if (!castlingBlocked)
-				{
-					moves.push_back(Move::CreateCastlingMove(state, friendlyColour, Castling::Kingside));
-				}
+			//Only the king can get out of double check
+			if (safety.CheckMask != Bitboard::Empty)
+			{
+				GeneratePieceMoves<Colour, Type>(board, board.ColourBitboards[Side<Colour>::Index], moves, safety);
 			}
+		}
 
-			if (((castleAvailability & Castling::Queenside) == Castling::Queenside))
+		template<int8 Colour>
+		void GenerateMoves(const State& board, const KingSafety& safety, MoveList& moves, uint8 type)
+		{
+			switch (type)
 			{
-				int8 startIdx = friendlyColour == Piece::White ? 3 : 59;
-				int8 endIdx = friendlyColour == Piece::White ? 2 : 57;
-				bool castlingBlocked = false;
+			case Captures: GenerateMoves<Colour, Captures>(board, safety, moves); break;
+			case Quiets: GenerateMoves<Colour, Quiets>(board, safety, moves); break;
+			default: GenerateMoves<Colour, Captures | Quiets>(board, safety, moves); break;
+			}
+		}
 
-				for (int idx = endIdx; idx < startIdx; idx++)
-				{
-					if (state.Squares[idx] != Piece::None || state.IsSquareThreatened(idx, friendlyColour))
-					{
-						castlingBlocked = true;
-						break;
-					}
-				}
+		//Generates just the moves of the piece on the move's start square, which is cheap enough to check a move from elsewhere
+		template<int8 Colour>
+		bool IsLegal(const State& board, const KingSafety& safety, const Move& move)
+		{
+			int8 startSquare = move.StartSquare();
+			if (!Bitboard::Contains(board.ColourBitboards[Side<Colour>::Index], startSquare))
+			{
+				return false;
+			}
 
-				if (!castlingBlocked)
-				{
-					moves.push_back(Move::CreateCastlingMove(state, friendlyColour, Castling::Queenside));
-				}
+			MoveList moves;
+			if (startSquare == safety.KingSquare)
+			{
+				GenerateKingMoves<Colour, Captures | Quiets>(board, moves, safety);
+			}
+			else if (safety.CheckMask != Bitboard::Empty)
+			{
+				GeneratePieceMoves<Colour, Captures | Quiets>(board, Bitboard::SquareMask(startSquare), moves, safety);
 			}
+
+			return moves.Contains(move);
+		}
+	}
+
+	uint64 MoveGeneration::AttackersTo(const State& board, int8 square, uint64 occupancy)
+	{
+		uint64 rooks = board.PieceBitboards[Piece::Rook] | board.PieceBitboards[Piece::Queen];
+		uint64 bishops = board.PieceBitboards[Piece::Bishop] | board.PieceBitboards[Piece::Queen];
+
+		//A pawn attacks a square if a pawn of the other colour on that square would attack it back
+		return (Attacks::Pawn(Utils::ColourIndex(Piece::White), square) & board.GetPieces(Piece::Black, Piece::Pawn)) |
+			(Attacks::Pawn(Utils::ColourIndex(Piece::Black), square) & board.GetPieces(Piece::White, Piece::Pawn)) |
+			(Attacks::Knight(square) & board.PieceBitboards[Piece::Knight]) |
+			(Attacks::King(square) & board.PieceBitboards[Piece::King]) |
+			(Attacks::Rook(square, occupancy) & rooks) |
+			(Attacks::Bishop(square, occupancy) & bishops);
+	}
+
+	MoveGeneration::KingSafety MoveGeneration::CalculateKingSafety(const State& board, int8 colour)
+	{
+		return colour == Piece::White ? Chess::CalculateKingSafety<Piece::White>(board) : Chess::CalculateKingSafety<Piece::Black>(board);
+	}
+
+	void MoveGeneration::GenerateMoves(const State& board, int8 colour, MoveList& moves, uint8 type /*= GenerationType::All*/)
+	{
+		if (colour == Piece::White)
+		{
+			Chess::GenerateMoves<Piece::White>(board, Chess::CalculateKingSafety<Piece::White>(board), moves, type);
+		}
+		else
+		{
+			Chess::GenerateMoves<Piece::Black>(board, Chess::CalculateKingSafety<Piece::Black>(board), moves, type);
 		}
 	}
 
-	std::vector<Move> MoveGeneration::GenerateMoves_Impl(const State& board, int8 colour, bool calculateThreat /*= false*/)
+	void MoveGeneration::GenerateMoves(const State& board, int8 colour, const KingSafety& safety, MoveList& moves, uint8 type)
 	{
-		std::vector<Move> moves;
-		for (int8 startSquare = 0; startSquare < 64; startSquare++)
+		if (colour == Piece::White)
 		{
-			int8 piece = board.Squares[startSquare];
+			Chess::GenerateMoves<Piece::White>(board, safety, moves, type);
+		}
+		else
+		{
+			Chess::GenerateMoves<Piece::Black>(board, safety, moves, type);
+		}
+	}
 
-			if (Utils::IsColour(piece, colour))
-			{
-				if (Utils::IsSlidingPiece(piece))
-				{
-					GenerateSlidingMoves(board, startSquare, moves);
-				}
+	bool MoveGeneration::IsLegal(const State& board, int8 colour, const KingSafety& safety, const Move& move)
+	{
+		return colour == Piece::White ? Chess::IsLegal<Piece::White>(board, safety, move) : Chess::IsLegal<Piece::Black>(board, safety, move);
+	}
 
-				if (Utils::IsType(piece, Piece::Knight))
-				{
-					GenerateKnightMoves(board, startSquare, moves);
-				}
+	uint64 MoveGeneration::GenerateAttackMap(const State& board, int8 colour)
+	{
+		uint64 friendly = board.GetPieces(colour);
+		uint64 attacks = Attacks::PawnSet(Utils::ColourIndex(colour), board.PieceBitboards[Piece::Pawn] & friendly);
 
-				if (Utils::IsType(piece, Piece::Pawn))
-				{
-					if (calculateThreat)
-					{
-						GeneratePawnAttacks(board, startSquare, moves, calculateThreat);
-					}
-					else
-					{
-						GeneratePawnMoves(board, startSquare, moves);
-						GeneratePawnAttacks(board, startSquare, moves);
-					}
-				}
+		uint64 knights = board.PieceBitboards[Piece::Knight] & friendly;
+		while (knights != Bitboard::Empty)
+		{
+			attacks |= Attacks::Knight(Bitboard::PopLSB(knights));
+		}
 
-				if (Utils::IsType(piece, Piece::King))
-				{
-					GenerateKingMoves(board, startSquare, moves, calculateThreat);
-				}
-			}
+		uint64 kings = board.PieceBitboards[Piece::King] & friendly;
+		while (kings != Bitboard::Empty)
+		{
+			attacks |= Attacks::King(Bitboard::PopLSB(kings));
+		}
+
+		uint64 rooks = (board.PieceBitboards[Piece::Rook] | board.PieceBitboards[Piece::Queen]) & friendly;
+		while (rooks != Bitboard::Empty)
+		{
+			attacks |= Attacks::Rook(Bitboard::PopLSB(rooks), board.Occupancy);
+		}
+
+		uint64 bishops = (board.PieceBitboards[Piece::Bishop] | board.PieceBitboards[Piece::Queen]) & friendly;
+		while (bishops != Bitboard::Empty)
+		{
+			attacks |= Attacks::Bishop(Bitboard::PopLSB(bishops), board.Occupancy);
 		}
 
-		return moves;
+		return attacks;
 	}
 }
\ No newline at end of file
@@ -1,28 +1,58 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include <vector>
 
 #include "State.h"
 #include "Move.h"
+#include "MoveList.h"
 
 namespace Chess
 {
 	namespace MoveGeneration
 	{
-		const int8 DirectionOffsets[8] = { 8, -8, -1, 1, 7, -7, 9, -9 };
+		//Everything about the moving side's king that legality depends on, worked out once per position
+		struct KingSafety
+		{
+			int8 KingSquare;
 
-		std::vector<Move> GenerateMoves(const State& board, int8 colour, bool calculateThreat = false);
+			//Enemy pieces giving check
+			uint64 Checkers;
 
-		//Includes illegal moves that would put the king in check
-		std::vector<Move> GenerateMoves_Impl(const State& board, int8 colour, bool calculateThreat = false);
-		void PruneIllegalMoves_Impl(const State& board, int8 colour, std::vector<Move>& moves);
+			//Friendly pieces that can only move along the line between the king and the piece pinning them
+			uint64 Pinned;
 
-		void GenerateSlidingMoves(const State& state, int8 startSquare, std::vector<Move>& moves);
-		void GenerateKnightMoves(const State& state, int8 startSquare, std::vector<Move>& moves);
-		void GeneratePawnMoves(const State& state, int8 startSquare, std::vector<Move>& moves);
-		void GeneratePawnAttacks(const State& state, int8 startSquare, std::vector<Move>& moves, bool calculateThreat = false);
-		void GenerateKingMoves(const State& state, int8 startSquare, std::vector<Move>& moves, bool calculateThreat = false);
+			//Squares a piece other than the king must move to: everywhere when not in check, the checker or a block when in
+			//single check, and nowhere in double check
+			uint64 CheckMask;
+
+			//Squares the king can't move to, including those behind it along the line of a sliding checker
+			uint64 KingDanger;
+		};
+
+		//Which moves to generate. Captures includes every promotion and en passent, Quiets is everything else including castling
+		namespace GenerationType
+		{
+			const uint8 Captures = 1;
+			const uint8 Quiets = 2;
+			const uint8 All = Captures | Quiets;
+		}
+
+		KingSafety CalculateKingSafety(const State& board, int8 colour);
+
+		//Fills moves in place with only the legal moves, the list is cleared first so callers can reuse one across calls
+		void GenerateMoves(const State& board, int8 colour, MoveList& moves, uint8 type = GenerationType::All);
+
+		//As above with the king safety already worked out, so a position can be generated a type at a time without repeating it
+		void GenerateMoves(const State& board, int8 colour, const KingSafety& safety, MoveList& moves, uint8 type);
+
+		//Whether a move from somewhere else, like a hash table or a killer slot, is legal here. The null move never is
+		bool IsLegal(const State& board, int8 colour, const KingSafety& safety, const Move& move);
+
+		//Every square the colour's pieces attack, whether or not anything is on that square
+		uint64 GenerateAttackMap(const State& board, int8 colour);
+
+		//All pieces of either colour attacking the square, given the occupancy
+		uint64 AttackersTo(const State& board, int8 square, uint64 occupancy);
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Move.h"
+
+namespace Chess
+{
+	/*
+		Fixed capacity list of moves, meant to live on the stack so generating moves never touches the allocator.
+		No legal position has more than 218 moves and the generators only ever add legal ones, so the capacity always has room to spare.
+	*/
+	struct MoveList
+	{
+	public:
+		static const int32 Capacity = 256;
+
+		MoveList() : Count(0) {}
+
+		inline void Add(const Move& move) { Moves[Count++] = move; }
+		inline void Clear() { Count = 0; }
+
+		inline int32 Size() const { return Count; }
+		inline bool IsEmpty() const { return Count == 0; }
+
+		inline bool Contains(const Move& move) const
+		{
+			for (int32 idx = 0; idx < Count; idx++)
+			{
+				if (Moves[idx] == move)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		inline Move& operator[](int32 index) { return Moves[index]; }
+		inline const Move& operator[](int32 index) const { return Moves[index]; }
+
+		inline Move* begin() { return Moves; }
+		inline Move* end() { return Moves + Count; }
+		inline const Move* begin() const { return Moves; }
+		inline const Move* end() const { return Moves + Count; }
+
+	private:
+		Move Moves[Capacity];
+		int32 Count;
+	};
+}
\ No newline at end of file
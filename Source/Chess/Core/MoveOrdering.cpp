@@ -0,0 +1,72 @@
+#include "MoveOrdering.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace Chess
+{
+	using namespace Constants;
+
+	namespace
+	{
+		//Pieces by type in order of value, the king last as an attacker since it can only take what isn't defended
+		const int32 VictimOrder[7] = { 0, 0, 1, 2, 3, 4, 5 };
+		const int32 AttackerOrder[7] = { 0, 6, 1, 2, 3, 4, 5 };
+
+		//Past this depth the bonus stops growing, so one deep cutoff can't swamp everything else in the table
+		const int32 MaxBonusDepth = 16;
+	}
+
+	int32 MoveOrdering::CaptureScore(const State& state, const Move& move)
+	{
+		//Taking en passent leaves the target square empty, but the pawn taken is worth the same as any other
+		int8 victim = move.IsEnPassentCapture() ? Piece::Pawn : Utils::GetType(state.Squares[move.TargetSquare()]);
+		int8 attacker = Utils::GetType(state.Squares[move.StartSquare()]);
+
+		return (VictimOrder[victim] + VictimOrder[move.Promote()]) * 8 - AttackerOrder[attacker];
+	}
+
+	MoveOrdering::ButterflyHistory::ButterflyHistory()
+	{
+		Clear();
+	}
+
+	void MoveOrdering::ButterflyHistory::Reward(int8 colour, const Move& move, int32 depth)
+	{
+		int32 clamped = std::min(depth, MaxBonusDepth);
+		Update(colour, move, clamped * clamped);
+	}
+
+	void MoveOrdering::ButterflyHistory::Penalise(int8 colour, const Move& move, int32 depth)
+	{
+		int32 clamped = std::min(depth, MaxBonusDepth);
+		Update(colour, move, -clamped * clamped);
+	}
+
+	void MoveOrdering::ButterflyHistory::Age()
+	{
+		for (auto& colourScores : Scores)
+		{
+			for (auto& fromScores : colourScores)
+			{
+				for (int32& score : fromScores)
+				{
+					score /= 2;
+				}
+			}
+		}
+	}
+
+	void MoveOrdering::ButterflyHistory::Clear()
+	{
+		memset(Scores, 0, sizeof(Scores));
+	}
+
+	void MoveOrdering::ButterflyHistory::Update(int8 colour, const Move& move, int32 bonus)
+	{
+		//The closer a score is to the limit the less a bonus in the same direction moves it, so it never gets past
+		int32& score = Scores[Utils::ColourIndex(colour)][move.StartSquare()][move.TargetSquare()];
+		score += bonus - score * std::abs(bonus) / MaxScore;
+	}
+}
\ No newline at end of file
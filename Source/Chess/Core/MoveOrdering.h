@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Move.h"
+#include "State.h"
+
+namespace Chess
+{
+	namespace MoveOrdering
+	{
+		//Quiet moves that caused a cutoff at each ply, the newest first
+		const int32 KillerSlots = 2;
+
+		//Most valuable victim, least valuable attacker: every capture of a bigger piece comes before any of a smaller one, and
+		//between captures of the same piece the cheapest attacker goes first. Promotions count as capturing the new piece
+		int32 CaptureScore(const State& state, const Move& move);
+
+		/*
+			Butterfly history: how often each quiet move, by colour and from and to square, has caused a cutoff. Moves that
+			refuted one position tend to refute its neighbours too. Scores are pulled towards zero as they grow so they stay
+			within MaxScore and recent cutoffs count for more than old ones.
+		*/
+		class ButterflyHistory
+		{
+		public:
+			static const int32 MaxScore = 16384;
+
+			ButterflyHistory();
+
+			inline int32 GetScore(int8 colour, const Move& move) const { return Scores[Utils::ColourIndex(colour)][move.StartSquare()][move.TargetSquare()]; }
+
+			//For the move that caused a cutoff at the depth and for each quiet move searched before it that didn't
+			void Reward(int8 colour, const Move& move, int32 depth);
+			void Penalise(int8 colour, const Move& move, int32 depth);
+
+			//Halves every score, so a new search still starts from what the last one learned but soon outweighs it
+			void Age();
+			void Clear();
+
+		private:
+			void Update(int8 colour, const Move& move, int32 bonus);
+
+			int32 Scores[2][64][64];
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "MovePicker.h"
+
+#include <algorithm>
+
+namespace Chess
+{
+	MovePicker::MovePicker(const State& state, const Move& hashMove, const Move* killers, const MoveOrdering::ButterflyHistory& history) :
+		Position(state), Safety(MoveGeneration::CalculateKingSafety(state, state.ColourToMove)), History(history), HashMove(hashMove), CapturesOnly(false),
+		CurrentStage(Stage::HashMove), Index(0)
+	{
+		std::copy(killers, killers + MoveOrdering::KillerSlots, Killers);
+	}
+
+	MovePicker::MovePicker(const State& state, const MoveOrdering::ButterflyHistory& history) :
+		Position(state), Safety(MoveGeneration::CalculateKingSafety(state, state.ColourToMove)), History(history), CapturesOnly(!IsInCheck()),
+		CurrentStage(Stage::GenerateCaptures), Index(0)
+	{}
+
+	bool MovePicker::Next(Move& move)
+	{
+		using namespace MoveGeneration;
+
+		switch (CurrentStage)
+		{
+		case Stage::HashMove:
+			CurrentStage = Stage::GenerateCaptures;
+			if (!HashMove.IsNull() && IsLegal(Position, Position.ColourToMove, Safety, HashMove))
+			{
+				move = HashMove;
+				return true;
+			}
+
+			//The hash move can't be handed out again, so make sure it won't match anything the later stages generate
+			HashMove = Move();
+			//Fall through
+		case Stage::GenerateCaptures:
+			GenerateMoves(Position, Position.ColourToMove, Safety, Moves, GenerationType::Captures);
+			for (int32 idx = 0; idx < Moves.Size(); idx++)
+			{
+				Scores[idx] = MoveOrdering::CaptureScore(Position, Moves[idx]);
+			}
+
+			Index = 0;
+			CurrentStage = Stage::Captures;
+			//Fall through
+		case Stage::Captures:
+			while (Index < Moves.Size())
+			{
+				move = PickBest();
+				if (move != HashMove)
+				{
+					return true;
+				}
+			}
+
+			if (CapturesOnly)
+			{
+				CurrentStage = Stage::Done;
+				return false;
+			}
+
+			Index = 0;
+			CurrentStage = Stage::Killers;
+			//Fall through
+		case Stage::Killers:
+			//Killers are only ever quiet moves, which the captures stage never hands out
+			while (Index < MoveOrdering::KillerSlots)
+			{
+				move = Killers[Index++];
+				if (!move.IsNull() && move != HashMove && IsLegal(Position, Position.ColourToMove, Safety, move))
+				{
+					return true;
+				}
+
+				Killers[Index - 1] = Move();
+			}
+
+			CurrentStage = Stage::GenerateQuiets;
+			//Fall through
+		case Stage::GenerateQuiets:
+			GenerateMoves(Position, Position.ColourToMove, Safety, Moves, GenerationType::Quiets);
+			for (int32 idx = 0; idx < Moves.Size(); idx++)
+			{
+				Scores[idx] = History.GetScore(Position.ColourToMove, Moves[idx]);
+			}
+
+			Index = 0;
+			CurrentStage = Stage::Quiets;
+			//Fall through
+		case Stage::Quiets:
+			while (Index < Moves.Size())
+			{
+				move = PickBest();
+				if (move != HashMove && !IsKiller(move))
+				{
+					return true;
+				}
+			}
+
+			CurrentStage = Stage::Done;
+			//Fall through
+		case Stage::Done:
+		default:
+			return false;
+		}
+	}
+
+	Move MovePicker::PickBest()
+	{
+		//Selection sort one step at a time, most nodes cut off after a move or two so sorting the whole list would be wasted
+		int32 best = Index;
+		for (int32 idx = Index + 1; idx < Moves.Size(); idx++)
+		{
+			if (Scores[idx] > Scores[best])
+			{
+				best = idx;
+			}
+		}
+
+		std::swap(Moves[best], Moves[Index]);
+		std::swap(Scores[best], Scores[Index]);
+		return Moves[Index++];
+	}
+
+	bool MovePicker::IsKiller(const Move& move) const
+	{
+		for (const Move& killer : Killers)
+		{
+			if (killer == move)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Move.h"
+#include "MoveGeneration.h"
+#include "MoveList.h"
+#include "MoveOrdering.h"
+#include "State.h"
+
+namespace Chess
+{
+	/*
+		Hands out the legal moves of a position one at a time, generating them in stages only as they're asked for: the hash
+		move first, then captures and promotions by MVV-LVA, then the killer moves, then the remaining quiet moves by their
+		history. A search that cuts off early never generates the quiets. Each stage is only sorted as far as it's used, every
+		move handed out is the best of those left. Every move generated is already legal, so there's nothing left to check.
+	*/
+	class MovePicker
+	{
+	public:
+		//The hash move may be null, or a move from another position, and killers hold KillerSlots moves that may be either,
+		//they're only tried if they're legal here
+		MovePicker(const State& state, const Move& hashMove, const Move* killers, const MoveOrdering::ButterflyHistory& history);
+
+		//For quiescence: only captures and promotions, unless in check where every evasion is handed out
+		MovePicker(const State& state, const MoveOrdering::ButterflyHistory& history);
+
+		//False once every move has been handed out
+		bool Next(Move& move);
+
+		inline bool IsInCheck() const { return Safety.Checkers != Bitboard::Empty; }
+
+	private:
+		enum class Stage : int8
+		{
+			HashMove,
+			GenerateCaptures,
+			Captures,
+			Killers,
+			GenerateQuiets,
+			Quiets,
+			Done
+		};
+
+		//Swaps the best scoring of the moves left into Index and hands it out
+		Move PickBest();
+		bool IsKiller(const Move& move) const;
+
+		const State& Position;
+		MoveGeneration::KingSafety Safety;
+		const MoveOrdering::ButterflyHistory& History;
+		Move HashMove;
+		Move Killers[MoveOrdering::KillerSlots];
+		bool CapturesOnly;
+
+		Stage CurrentStage;
+		MoveList Moves;
+		int32 Scores[MoveList::Capacity];
+		int32 Index;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,496 @@
+#include "Nnue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+#include "Bitboard.h"
+#include "Board.h"
+#include "State.h"
+#include "Utils.h"
+
+//Vectorise the network with AVX2 or SSE2 where the target CPU has them, otherwise fall back to plain loops
+#if !defined(CHESS_NNUE_SIMD)
+#if defined(__AVX2__)
+#define CHESS_NNUE_SIMD 2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHESS_NNUE_SIMD 1
+#else
+#define CHESS_NNUE_SIMD 0
+#endif
+#endif
+
+#if CHESS_NNUE_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Chess
+{
+	using namespace Constants;
+	using namespace Nnue;
+
+	namespace
+	{
+		const uint32 FileVersion = 0x7AF32F16;
+
+		//Hashes of the network's architecture as Stockfish 12 writes them, only checked against networks it wrote
+		const uint32 TransformerHash = 0x5D69D7B8;
+		const uint32 NetworkHash = 0x63337156;
+		const uint32 FileHash = TransformerHash ^ NetworkHash;
+
+		//Start of each piece's block of squares. Own pieces come before the opponent's of the same type, and the blocks
+		//start from 1 as index 0 was reserved for a feature never used
+		inline int32 PieceSquareBase(int8 colourIdx, int8 piece)
+		{
+			int32 own = Utils::ColourIndex(piece) == colourIdx ? 0 : 1;
+			return 1 + ((Utils::GetType(piece) - Piece::Pawn) * 2 + own) * 64;
+		}
+
+		//Black sees the board rotated, so the same weights serve both sides
+		inline int8 Orient(int8 colourIdx, int8 square)
+		{
+			return colourIdx == 0 ? square : square ^ 63;
+		}
+
+		inline bool IsKing(int8 piece)
+		{
+			return Utils::IsType(piece, Piece::King);
+		}
+
+		/*
+			The kernels, each in a scalar form which is always there to check the others against and a vectorised form used when
+			the target allows. Row lengths are all multiples of 32, so no loop needs a remainder.
+		*/
+		namespace Scalar
+		{
+			inline void AddRow(int16* values, const int16* row)
+			{
+				for (int32 idx = 0; idx < HalfDimensions; idx++)
+				{
+					values[idx] += row[idx];
+				}
+			}
+
+			inline void SubtractRow(int16* values, const int16* row)
+			{
+				for (int32 idx = 0; idx < HalfDimensions; idx++)
+				{
+					values[idx] -= row[idx];
+				}
+			}
+
+			//Clamps a half of the accumulator to the 0-127 the first layer takes
+			inline void Transform(const int16* values, uint8* output)
+			{
+				for (int32 idx = 0; idx < HalfDimensions; idx++)
+				{
+					output[idx] = static_cast<uint8>(std::min<int32>(std::max<int32>(values[idx], 0), 127));
+				}
+			}
+
+			inline int32 Dot(const uint8* input, const int8* weights, int32 length)
+			{
+				int32 sum = 0;
+				for (int32 idx = 0; idx < length; idx++)
+				{
+					sum += static_cast<int32>(input[idx]) * weights[idx];
+				}
+
+				return sum;
+			}
+		}
+
+#if CHESS_NNUE_SIMD == 2
+		namespace Simd
+		{
+			const int32 Width = 16;
+
+			inline void AddRow(int16* values, const int16* row)
+			{
+				for (int32 idx = 0; idx < HalfDimensions; idx += Width)
+				{
+					__m256i sum = _mm256_add_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + idx)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + idx)));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + idx), sum);
+				}
+			}
+
+			inline void SubtractRow(int16* values, const int16* row)
+			{
+				for (int32 idx = 0; idx < HalfDimensions; idx += Width)
+				{
+					__m256i difference = _mm256_sub_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + idx)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + idx)));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + idx), difference);
+				}
+			}
+
+			inline void Transform(const int16* values, uint8* output)
+			{
+				//Packing saturates at 127 and works within each 128-bit lane, so the lanes need putting back in order after
+				const __m256i zero = _mm256_setzero_si256();
+				for (int32 idx = 0; idx < HalfDimensions; idx += Width * 2)
+				{
+					__m256i low = _mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + idx)), zero);
+					__m256i high = _mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + idx + Width)), zero);
+					__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + idx), packed);
+				}
+			}
+
+			inline int32 Dot(const uint8* input, const int8* weights, int32 length)
+			{
+				//Inputs are at most 127, so the pairs maddubs adds can't saturate
+				const __m256i ones = _mm256_set1_epi16(1);
+				__m256i sum = _mm256_setzero_si256();
+				for (int32 idx = 0; idx < length; idx += 32)
+				{
+					__m256i products = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + idx)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + idx)));
+					sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+				}
+
+				__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+				half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+				half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+				return _mm_cvtsi128_si32(half);
+			}
+		}
+#elif CHESS_NNUE_SIMD == 1
+		namespace Simd
+		{
+			const int32 Width = 8;
+
+			inline void AddRow(int16* values, const int16* row)
+			{
+				for (int32 idx = 0; idx < HalfDimensions; idx += Width)
+				{
+					__m128i sum = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + idx)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + idx)));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(values + idx), sum);
+				}
+			}
+
+			inline void SubtractRow(int16* values, const int16* row)
+			{
+				for (int32 idx = 0; idx < HalfDimensions; idx += Width)
+				{
+					__m128i difference = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + idx)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + idx)));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(values + idx), difference);
+				}
+			}
+
+			inline void Transform(const int16* values, uint8* output)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				for (int32 idx = 0; idx < HalfDimensions; idx += Width * 2)
+				{
+					__m128i low = _mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + idx)), zero);
+					__m128i high = _mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + idx + Width)), zero);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(output + idx), _mm_packs_epi16(low, high));
+				}
+			}
+
+			inline int32 Dot(const uint8* input, const int8* weights, int32 length)
+			{
+				//SSE2 has no unsigned by signed byte multiply, so both are widened to 16 bits first. Repeating each weight in
+				//both bytes of a word then shifting down sign extends it
+				const __m128i zero = _mm_setzero_si128();
+				__m128i sum = _mm_setzero_si128();
+				for (int32 idx = 0; idx < length; idx += 16)
+				{
+					__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + idx));
+					__m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + idx));
+					__m128i lowProducts = _mm_madd_epi16(_mm_unpacklo_epi8(in, zero), _mm_srai_epi16(_mm_unpacklo_epi8(weight, weight), 8));
+					__m128i highProducts = _mm_madd_epi16(_mm_unpackhi_epi8(in, zero), _mm_srai_epi16(_mm_unpackhi_epi8(weight, weight), 8));
+					sum = _mm_add_epi32(sum, _mm_add_epi32(lowProducts, highProducts));
+				}
+
+				sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+				sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+				return _mm_cvtsi128_si32(sum);
+			}
+		}
+#else
+		namespace Simd = Scalar;
+#endif
+
+		//One affine layer followed by clipping to 0-127 for the next
+		template<typename Dot>
+		void Hidden(const uint8* input, int32 inputs, const int32* biases, const int8* weights, uint8* output, Dot dot)
+		{
+			for (int32 idx = 0; idx < HiddenDimensions; idx++)
+			{
+				int32 sum = biases[idx] + dot(input, weights + idx * inputs, inputs);
+				output[idx] = static_cast<uint8>(std::min(std::max(sum >> WeightScaleBits, 0), 127));
+			}
+		}
+
+		template<typename TransformFn, typename DotFn>
+		int32 Propagate(const Nnue::Network& network, const Nnue::Accumulator& accumulator, int8 colourToMove, TransformFn transform, DotFn dot)
+		{
+			alignas(64) uint8 transformed[Nnue::Hidden1Inputs];
+			alignas(64) uint8 hidden1[HiddenDimensions];
+			alignas(64) uint8 hidden2[HiddenDimensions];
+
+			int8 us = Utils::ColourIndex(colourToMove);
+			transform(accumulator.Values[us], transformed);
+			transform(accumulator.Values[us ^ 1], transformed + HalfDimensions);
+
+			Hidden(transformed, Nnue::Hidden1Inputs, network.Hidden1Biases.data(), network.Hidden1Weights.data(), hidden1, dot);
+			Hidden(hidden1, HiddenDimensions, network.Hidden2Biases.data(), network.Hidden2Weights.data(), hidden2, dot);
+
+			int32 output = network.OutputBias + dot(hidden2, network.OutputWeights.data(), HiddenDimensions);
+			return output / OutputScale;
+		}
+
+		template<typename AddFn>
+		void Refresh(const Nnue::Network& network, const State& state, int8 colourIdx, int16* values, AddFn add)
+		{
+			std::memcpy(values, network.TransformerBiases.data(), sizeof(int16) * HalfDimensions);
+
+			int8 king = state.KingSquares[colourIdx];
+			uint64 pieces = state.Occupancy & ~state.PieceBitboards[Piece::King];
+			while (pieces != Bitboard::Empty)
+			{
+				int8 square = Bitboard::PopLSB(pieces);
+				add(values, network.TransformerWeights.data() + Nnue::FeatureIndex(colourIdx, king, state.Squares[square], square) * HalfDimensions);
+			}
+		}
+
+		template<typename T>
+		bool Read(std::istream& stream, T* values, size_t count)
+		{
+			stream.read(reinterpret_cast<char*>(values), sizeof(T) * count);
+			return static_cast<bool>(stream);
+		}
+
+		template<typename T>
+		void Write(std::ostream& stream, const T* values, size_t count)
+		{
+			stream.write(reinterpret_cast<const char*>(values), sizeof(T) * count);
+		}
+	}
+
+	Nnue::Network::Network() :
+		TransformerBiases(HalfDimensions), TransformerWeights(static_cast<size_t>(Features) * HalfDimensions),
+		Hidden1Biases(HiddenDimensions), Hidden1Weights(HiddenDimensions * Hidden1Inputs),
+		Hidden2Biases(HiddenDimensions), Hidden2Weights(HiddenDimensions * HiddenDimensions),
+		OutputBias(0), OutputWeights(HiddenDimensions)
+	{
+	}
+
+	bool Nnue::Network::Load(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return file && Load(file);
+	}
+
+	bool Nnue::Network::Load(std::istream& stream)
+	{
+		//Read into a spare so a bad file leaves this network untouched. Files are little endian, as is everything we run on
+		Network loaded;
+
+		uint32 version = 0;
+		uint32 hash = 0;
+		uint32 descriptionLength = 0;
+		if (!Read(stream, &version, 1) || !Read(stream, &hash, 1) || !Read(stream, &descriptionLength, 1) || version != FileVersion)
+		{
+			return false;
+		}
+
+		std::string description(descriptionLength, '\0');
+		uint32 transformerHash = 0;
+		uint32 networkHash = 0;
+		bool read = Read(stream, &description[0], descriptionLength) &&
+			Read(stream, &transformerHash, 1) &&
+			Read(stream, loaded.TransformerBiases.data(), loaded.TransformerBiases.size()) &&
+			Read(stream, loaded.TransformerWeights.data(), loaded.TransformerWeights.size()) &&
+			Read(stream, &networkHash, 1) &&
+			Read(stream, loaded.Hidden1Biases.data(), loaded.Hidden1Biases.size()) &&
+			Read(stream, loaded.Hidden1Weights.data(), loaded.Hidden1Weights.size()) &&
+			Read(stream, loaded.Hidden2Biases.data(), loaded.Hidden2Biases.size()) &&
+			Read(stream, loaded.Hidden2Weights.data(), loaded.Hidden2Weights.size()) &&
+			Read(stream, &loaded.OutputBias, 1) &&
+			Read(stream, loaded.OutputWeights.data(), loaded.OutputWeights.size());
+
+		//Anything left over means the file is for a bigger network than this one
+		if (!read || hash != FileHash || transformerHash != TransformerHash || networkHash != NetworkHash || stream.peek() != std::char_traits<char>::eof())
+		{
+			return false;
+		}
+
+		*this = std::move(loaded);
+		return true;
+	}
+
+	bool Nnue::Network::Save(std::ostream& stream) const
+	{
+		static const char Description[] = "Chess HalfKP(256x2)-32-32-1";
+		uint32 descriptionLength = sizeof(Description) - 1;
+
+		Write(stream, &FileVersion, 1);
+		Write(stream, &FileHash, 1);
+		Write(stream, &descriptionLength, 1);
+		Write(stream, Description, descriptionLength);
+		Write(stream, &TransformerHash, 1);
+		Write(stream, TransformerBiases.data(), TransformerBiases.size());
+		Write(stream, TransformerWeights.data(), TransformerWeights.size());
+		Write(stream, &NetworkHash, 1);
+		Write(stream, Hidden1Biases.data(), Hidden1Biases.size());
+		Write(stream, Hidden1Weights.data(), Hidden1Weights.size());
+		Write(stream, Hidden2Biases.data(), Hidden2Biases.size());
+		Write(stream, Hidden2Weights.data(), Hidden2Weights.size());
+		Write(stream, &OutputBias, 1);
+		Write(stream, OutputWeights.data(), OutputWeights.size());
+		return static_cast<bool>(stream);
+	}
+
+	void Nnue::Network::Randomise(uint64 seed)
+	{
+		//Small enough that no accumulator can overflow with every piece on the board
+		Utils::Random random(seed);
+		auto next = [&random](int32 range) { return static_cast<int32>(random.Next() % (2 * range + 1)) - range; };
+
+		for (int16& bias : TransformerBiases) bias = static_cast<int16>(next(64));
+		for (int16& weight : TransformerWeights) weight = static_cast<int16>(next(32));
+		for (int32& bias : Hidden1Biases) bias = next(1024);
+		for (int8& weight : Hidden1Weights) weight = static_cast<int8>(next(127));
+		for (int32& bias : Hidden2Biases) bias = next(1024);
+		for (int8& weight : Hidden2Weights) weight = static_cast<int8>(next(127));
+		OutputBias = next(1024);
+		for (int8& weight : OutputWeights) weight = static_cast<int8>(next(127));
+	}
+
+	int32 Nnue::FeatureIndex(int8 colourIdx, int8 kingSquare, int8 piece, int8 square)
+	{
+		return Orient(colourIdx, square) + PieceSquareBase(colourIdx, piece) + PieceSquares * Orient(colourIdx, kingSquare);
+	}
+
+	void Nnue::RecordMove(const State& state, const Move& move, Accumulator& accumulator)
+	{
+		DirtyPieces& dirty = accumulator.Dirty;
+		accumulator.Computed[0] = false;
+		accumulator.Computed[1] = false;
+
+		int8 start = move.StartSquare();
+		int8 target = move.TargetSquare();
+		int8 mover = state.Squares[start];
+
+		//Taking en passent is the only capture not on the target square
+		int8 capturedSquare = move.IsEnPassentCapture() ? move.SecondaryStart() : target;
+		int8 captured = move.Castle() == Castling::None ? state.Squares[capturedSquare] : Piece::None;
+
+		dirty.Count = 0;
+		if (move.IsPromotion())
+		{
+			dirty.Pieces[dirty.Count] = mover;
+			dirty.From[dirty.Count] = start;
+			dirty.To[dirty.Count++] = DEFAULT;
+
+			dirty.Pieces[dirty.Count] = state.ColourToMove | move.Promote();
+			dirty.From[dirty.Count] = DEFAULT;
+			dirty.To[dirty.Count++] = target;
+		}
+		else
+		{
+			dirty.Pieces[dirty.Count] = mover;
+			dirty.From[dirty.Count] = start;
+			dirty.To[dirty.Count++] = target;
+		}
+
+		if (captured != Piece::None)
+		{
+			dirty.Pieces[dirty.Count] = captured;
+			dirty.From[dirty.Count] = capturedSquare;
+			dirty.To[dirty.Count++] = DEFAULT;
+		}
+
+		if (move.Castle() != Castling::None)
+		{
+			dirty.Pieces[dirty.Count] = state.Squares[move.SecondaryStart()];
+			dirty.From[dirty.Count] = move.SecondaryStart();
+			dirty.To[dirty.Count++] = move.SecondaryTarget();
+		}
+	}
+
+	int32 Nnue::Evaluate(Board& board)
+	{
+		const Network& network = *board.GetNetwork();
+		const State& state = board.BoardState;
+		std::vector<Accumulator>& accumulators = board.Accumulators;
+		int32 current = static_cast<int32>(accumulators.size()) - 1;
+		Accumulator& accumulator = accumulators[current];
+
+		for (int8 colourIdx = 0; colourIdx < 2; colourIdx++)
+		{
+			if (accumulator.Computed[colourIdx])
+			{
+				continue;
+			}
+
+			//Find the latest position this side is up to date in. Moving its own king changes every one of its features, so
+			//there's no going back past that, or past the first position
+			int32 latest = current;
+			bool refresh = false;
+			while (!accumulators[latest].Computed[colourIdx])
+			{
+				const DirtyPieces& dirty = accumulators[latest].Dirty;
+				if (latest == 0 || (dirty.Count > 0 && IsKing(dirty.Pieces[0]) && Utils::ColourIndex(dirty.Pieces[0]) == colourIdx))
+				{
+					refresh = true;
+					break;
+				}
+
+				latest--;
+			}
+
+			if (refresh)
+			{
+				Refresh(network, state, colourIdx, accumulator.Values[colourIdx], Simd::AddRow);
+				accumulator.Computed[colourIdx] = true;
+				continue;
+			}
+
+			//Replay the changes since, the king hasn't moved so every step uses the king square it's on now
+			int8 king = state.KingSquares[colourIdx];
+			for (int32 idx = latest + 1; idx <= current; idx++)
+			{
+				int16* values = accumulators[idx].Values[colourIdx];
+				std::memcpy(values, accumulators[idx - 1].Values[colourIdx], sizeof(int16) * HalfDimensions);
+
+				const DirtyPieces& dirty = accumulators[idx].Dirty;
+				for (int8 change = 0; change < dirty.Count; change++)
+				{
+					if (IsKing(dirty.Pieces[change]))
+					{
+						continue;
+					}
+
+					if (dirty.From[change] != DEFAULT)
+					{
+						Simd::SubtractRow(values, network.TransformerWeights.data() + FeatureIndex(colourIdx, king, dirty.Pieces[change], dirty.From[change]) * HalfDimensions);
+					}
+
+					if (dirty.To[change] != DEFAULT)
+					{
+						Simd::AddRow(values, network.TransformerWeights.data() + FeatureIndex(colourIdx, king, dirty.Pieces[change], dirty.To[change]) * HalfDimensions);
+					}
+				}
+
+				accumulators[idx].Computed[colourIdx] = true;
+			}
+		}
+
+		return Propagate(network, accumulator, state.ColourToMove, Simd::Transform, Simd::Dot);
+	}
+
+	int32 Nnue::EvaluateFromScratch(const Network& network, const State& state)
+	{
+		Accumulator accumulator;
+		for (int8 colourIdx = 0; colourIdx < 2; colourIdx++)
+		{
+			Refresh(network, state, colourIdx, accumulator.Values[colourIdx], Scalar::AddRow);
+		}
+
+		return Propagate(network, accumulator, state.ColourToMove, Scalar::Transform, Scalar::Dot);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "Move.h"
+
+namespace Chess
+{
+	class Board;
+	struct State;
+
+	namespace Nnue
+	{
+		//HalfKP features: for each side's king square, every non-king piece on every square, from that side's point of view
+		const int32 PieceSquares = 10 * 64 + 1;
+		const int32 Features = 64 * PieceSquares;
+
+		//Layer sizes. The feature transformer's output is one half per side, the side to move's first
+		const int32 HalfDimensions = 256;
+		const int32 Hidden1Inputs = HalfDimensions * 2;
+		const int32 HiddenDimensions = 32;
+
+		//Hidden layer sums are shifted down by this before clipping, and the output divided by OutputScale to give centipawns
+		const int32 WeightScaleBits = 6;
+		const int32 OutputScale = 16;
+
+		//What the move into a position changed, which is all the accumulators need to follow it. A promotion counts as the
+		//pawn leaving the board and the new piece arriving, so with a capture that's three changes, one more than castling's two
+		struct DirtyPieces
+		{
+			static const int8 MaxDirty = 3;
+
+			int8 Count;
+			int8 Pieces[MaxDirty];
+
+			//-1 for a piece arriving from off the board or leaving it
+			int8 From[MaxDirty];
+			int8 To[MaxDirty];
+		};
+
+		//The feature transformer's output for one position, worked out lazily from the one before it where possible
+		struct alignas(64) Accumulator
+		{
+			int16 Values[2][HalfDimensions];
+
+			//Indexed by colour index, whether Values is up to date for that side
+			bool Computed[2];
+
+			DirtyPieces Dirty;
+		};
+
+		/*
+			The network's weights. Laid out as in the files: HalfKP(256x2)-32-32-1, the layout Stockfish 12 shipped, so its
+			networks load as they are. Read only once loaded, so any number of boards and threads can share one.
+		*/
+		class Network
+		{
+		public:
+			Network();
+
+			//False, leaving the network as it was, if the file can't be read or isn't a network of this shape
+			bool Load(const std::string& path);
+			bool Load(std::istream& stream);
+			bool Save(std::ostream& stream) const;
+
+			//Small random weights, for checking the evaluation paths agree without a trained network to hand
+			void Randomise(uint64 seed);
+
+			std::vector<int16> TransformerBiases;
+			std::vector<int16> TransformerWeights;
+
+			//Affine layers, weights indexed by output then input
+			std::vector<int32> Hidden1Biases;
+			std::vector<int8> Hidden1Weights;
+			std::vector<int32> Hidden2Biases;
+			std::vector<int8> Hidden2Weights;
+			int32 OutputBias;
+			std::vector<int8> OutputWeights;
+		};
+
+		//Index of a piece's feature from the point of view of the colour index, with that side's king on kingSquare
+		int32 FeatureIndex(int8 colourIdx, int8 kingSquare, int8 piece, int8 square);
+
+		//Fills in what the move changes from the state it's about to be made in, for the accumulator after it
+		void RecordMove(const State& state, const Move& move, Accumulator& accumulator);
+
+		//Score of the board's position for the side to move, bringing its accumulators up to date. The board must have a network
+		int32 Evaluate(Board& board);
+
+		//The same score worked out from scratch without SIMD, to check the incremental and vectorised paths against
+		int32 EvaluateFromScratch(const Network& network, const State& state);
+	}
+}
\ No newline at end of file
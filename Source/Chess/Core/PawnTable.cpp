@@ -0,0 +1,46 @@
+#include "PawnTable.h"
+
+#include "Evaluation.h"
+
+namespace Chess
+{
+	PawnTable::PawnTable(int32 sizeKB /*= DefaultSizeKB*/) :
+		Probes(0), Hits(0)
+	{
+		//Round down to a power of two so the index is just the low bits of the key
+		uint64 entries = (static_cast<uint64>(sizeKB) << 10) / sizeof(PawnEntry);
+		uint64 size = 1;
+		while (size * 2 <= entries)
+		{
+			size *= 2;
+		}
+
+		Entries.resize(size);
+		IndexMask = size - 1;
+		Clear();
+	}
+
+	const PawnEntry& PawnTable::Probe(const State& state)
+	{
+		Probes++;
+
+		PawnEntry& entry = Entries[state.PawnKey & IndexMask];
+		if (entry.Key == state.PawnKey)
+		{
+			Hits++;
+			return entry;
+		}
+
+		entry.Key = state.PawnKey;
+		Evaluation::EvaluatePawns(state, entry);
+		return entry;
+	}
+
+	void PawnTable::Clear()
+	{
+		//A zeroed entry is only found for key 0, a board with no pawns or kings, which it gets right anyway
+		memset(Entries.data(), 0, Entries.size() * sizeof(PawnEntry));
+		Probes = 0;
+		Hits = 0;
+	}
+}
\ No newline at end of file
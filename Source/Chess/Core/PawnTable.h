@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <vector>
+
+#include "PieceSquareTables.h"
+#include "State.h"
+
+namespace Chess
+{
+	//Everything worked out from the pawns and kings alone
+	struct PawnEntry
+	{
+		uint64 Key;
+
+		//From white's point of view, like State::PieceSquareScore
+		PieceSquare::Score Score;
+
+		//Both colours' passed pawns, split them with the colour bitboards
+		uint64 PassedPawns;
+	};
+
+	/*
+		Cache of pawn structure evaluations, keyed by State::PawnKey. Pawns move in few enough of the moves searched that
+		almost every probe hits, so the pawn terms cost next to nothing. Not thread safe, each search thread keeps its own.
+	*/
+	class PawnTable
+	{
+	public:
+		static const int32 DefaultSizeKB = 1024;
+
+		explicit PawnTable(int32 sizeKB = DefaultSizeKB);
+
+		//The entry for the state's pawns and kings, evaluated and stored first if it isn't in the table already
+		const PawnEntry& Probe(const State& state);
+		void Clear();
+
+		inline int64 GetProbes() const { return Probes; }
+		inline int64 GetHits() const { return Hits; }
+		inline double GetHitRate() const { return Probes == 0 ? 0.0 : static_cast<double>(Hits) / Probes; }
+
+	private:
+		std::vector<PawnEntry> Entries;
+		uint64 IndexMask;
+
+		int64 Probes;
+		int64 Hits;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "Perft.h"
+
+#include "MoveGeneration.h"
+#include "MoveList.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Chess
+{
+	namespace
+	{
+		//Deep enough to give every thread plenty of subtrees from any position, each split multiplies the count by the branching factor
+		const int8 MaxSplitPly = 3;
+		const int32 SubtreesPerThread = 16;
+
+		//The moves leading from the root to a subtree
+		struct Subtree
+		{
+			Move Path[MaxSplitPly];
+			int8 Length;
+		};
+
+		struct WorkQueue
+		{
+			std::mutex Lock;
+			std::deque<Subtree> Subtrees;
+		};
+
+		std::vector<Subtree> SplitTree(const Board& root, int32 depth, int32 threads)
+		{
+			std::vector<Subtree> subtrees(1);
+			subtrees[0].Length = 0;
+
+			//Always leave at least one ply for the workers so they count leaves the same way Count does
+			for (int8 ply = 0; ply < MaxSplitPly && ply < depth - 1 && static_cast<int32>(subtrees.size()) < threads * SubtreesPerThread; ply++)
+			{
+				std::vector<Subtree> children;
+				Board board(root);
+				MoveList moves;
+				for (const Subtree& parent : subtrees)
+				{
+					for (int8 idx = 0; idx < parent.Length; idx++)
+					{
+						board.ApplyMove(parent.Path[idx]);
+					}
+
+					MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove(), moves);
+					for (const Move& move : moves)
+					{
+						Subtree child = parent;
+						child.Path[child.Length++] = move;
+						children.push_back(child);
+					}
+
+					for (int8 idx = 0; idx < parent.Length; idx++)
+					{
+						board.UnmakeMove();
+					}
+				}
+
+				subtrees.swap(children);
+			}
+
+			return subtrees;
+		}
+
+		int64 CountCached(Board& board, int32 depth, PerftCache& cache, int64& probes, int64& hits)
+		{
+			if (depth <= 1)
+			{
+				return Perft::Count(board, depth);
+			}
+
+			int64 nodes = 0;
+			probes++;
+			if (cache.Probe(board.GetKey(), depth, nodes))
+			{
+				hits++;
+				return nodes;
+			}
+
+			MoveList moves;
+			MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove(), moves);
+			for (const Move& move : moves)
+			{
+				board.ApplyMove(move);
+				nodes += CountCached(board, depth - 1, cache, probes, hits);
+				board.UnmakeMove();
+			}
+
+			cache.Store(board.GetKey(), depth, nodes);
+			return nodes;
+		}
+
+		//Own queue from the front, then everyone else's from the back so thieves take the work the owner would get to last
+		bool NextSubtree(std::vector<WorkQueue>& queues, int32 self, Subtree& subtree, bool& stolen)
+		{
+			int32 numQueues = static_cast<int32>(queues.size());
+			for (int32 offset = 0; offset < numQueues; offset++)
+			{
+				WorkQueue& queue = queues[(self + offset) % numQueues];
+				std::lock_guard<std::mutex> lock(queue.Lock);
+				if (queue.Subtrees.empty())
+				{
+					continue;
+				}
+
+				stolen = offset != 0;
+				if (stolen)
+				{
+					subtree = queue.Subtrees.back();
+					queue.Subtrees.pop_back();
+				}
+				else
+				{
+					subtree = queue.Subtrees.front();
+					queue.Subtrees.pop_front();
+				}
+
+				return true;
+			}
+
+			return false;
+		}
+	}
+
+	PerftCache::PerftCache(int32 sizeMB) :
+		Probes(0), Hits(0)
+	{
+		//Round down to a power of two so the index is just the low bits of the key
+		uint64 entries = (static_cast<uint64>(sizeMB) << 20) / sizeof(Entry);
+		EntryCount = 1;
+		while (EntryCount * 2 <= entries)
+		{
+			EntryCount *= 2;
+		}
+
+		Entries.reset(new Entry[EntryCount]);
+		IndexMask = EntryCount - 1;
+		Clear();
+	}
+
+	bool PerftCache::Probe(uint64 key, int32 depth, int64& count) const
+	{
+		const Entry& entry = Entries[key & IndexMask];
+		uint64 data = entry.Data.load(std::memory_order_relaxed);
+		uint64 check = entry.Check.load(std::memory_order_relaxed);
+		if ((check ^ data) != key || static_cast<int32>(data & 0xFF) != depth)
+		{
+			return false;
+		}
+
+		count = static_cast<int64>(data >> 8);
+		return true;
+	}
+
+	void PerftCache::Store(uint64 key, int32 depth, int64 count)
+	{
+		Entry& entry = Entries[key & IndexMask];
+		uint64 data = (static_cast<uint64>(count) << 8) | static_cast<uint64>(depth & 0xFF);
+		entry.Data.store(data, std::memory_order_relaxed);
+		entry.Check.store(key ^ data, std::memory_order_relaxed);
+	}
+
+	void PerftCache::Clear()
+	{
+		//A zeroed slot only matches key 0 at depth 0, which is never probed
+		memset(static_cast<void*>(Entries.get()), 0, EntryCount * sizeof(Entry));
+		Probes.store(0, std::memory_order_relaxed);
+		Hits.store(0, std::memory_order_relaxed);
+	}
+
+	void PerftCache::AddStats(int64 probes, int64 hits)
+	{
+		Probes.fetch_add(probes, std::memory_order_relaxed);
+		Hits.fetch_add(hits, std::memory_order_relaxed);
+	}
+
+	int64 Perft::Count(Board& board, int32 depth)
+	{
+		if (depth == 0)
+		{
+			return 1;
+		}
+
+		MoveList moves;
+		MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove(), moves);
+
+		//The generator is legal only, so the last ply doesn't need making
+		if (depth == 1)
+		{
+			return moves.Size();
+		}
+
+		int64 nodes = 0;
+		for (const Move& move : moves)
+		{
+			board.ApplyMove(move);
+			nodes += Count(board, depth - 1);
+			board.UnmakeMove();
+		}
+
+		return nodes;
+	}
+
+	int64 Perft::Count(Board& board, int32 depth, PerftCache& cache)
+	{
+		int64 probes = 0;
+		int64 hits = 0;
+		int64 nodes = CountCached(board, depth, cache, probes, hits);
+		cache.AddStats(probes, hits);
+		return nodes;
+	}
+
+	std::vector<std::pair<Move, int64>> Perft::Divide(Board& board, int32 depth)
+	{
+		std::vector<std::pair<Move, int64>> counts;
+		if (depth <= 0)
+		{
+			return counts;
+		}
+
+		MoveList moves;
+		MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove(), moves);
+		for (const Move& move : moves)
+		{
+			board.ApplyMove(move);
+			counts.emplace_back(move, Count(board, depth - 1));
+			board.UnmakeMove();
+		}
+
+		return counts;
+	}
+
+	bool Perft::ParseSuiteLine(const std::string& line, SuitePosition& position)
+	{
+		size_t firstOp = line.find(';');
+		size_t start = line.find_first_not_of(" \t\r");
+		if (firstOp == std::string::npos || start >= firstOp || line[start] == '#')
+		{
+			return false;
+		}
+
+		size_t end = line.find_last_not_of(' ', firstOp - 1);
+		position.Fen = line.substr(start, end + 1 - start);
+		position.Expected.clear();
+
+		for (size_t op = firstOp; op != std::string::npos; op = line.find(';', op + 1))
+		{
+			size_t name = line.find_first_not_of(' ', op + 1);
+			if (name == std::string::npos || line[name] != 'D')
+			{
+				continue;
+			}
+
+			char* afterDepth = nullptr;
+			int32 depth = static_cast<int32>(std::strtol(line.c_str() + name + 1, &afterDepth, 10));
+			int64 count = std::strtoll(afterDepth, nullptr, 10);
+			if (depth > 0)
+			{
+				position.Expected.emplace_back(depth, count);
+			}
+		}
+
+		return !position.Expected.empty();
+	}
+
+	namespace
+	{
+		//Shared by both ParallelCount overloads, workers only use the cache if there is one
+		Perft::ParallelResult CountParallel(const Board& board, int32 depth, int32 threads, PerftCache* cache)
+		{
+			using namespace std::chrono;
+			using namespace Perft;
+
+			threads = std::max(threads, 1);
+			auto start = steady_clock::now();
+
+			ParallelResult result;
+			result.Nodes = 0;
+			result.Workers.resize(threads);
+
+			if (depth <= 1)
+			{
+				Board copy(board);
+				result.Nodes = cache != nullptr ? Count(copy, depth, *cache) : Count(copy, depth);
+				result.Seconds = duration<double>(steady_clock::now() - start).count();
+				result.Workers[0] = { result.Nodes, result.Seconds, 1, 0 };
+				return result;
+			}
+
+			//Deal the subtrees round robin so every queue starts with a similar spread of early and late moves
+			std::vector<Subtree> subtrees = SplitTree(board, depth, threads);
+			std::vector<WorkQueue> queues(threads);
+			for (size_t idx = 0; idx < subtrees.size(); idx++)
+			{
+				queues[idx % threads].Subtrees.push_back(subtrees[idx]);
+			}
+
+			auto work = [&](int32 self)
+			{
+				auto workerStart = steady_clock::now();
+				WorkerStats& stats = result.Workers[self];
+				stats = { 0, 0.0, 0, 0 };
+
+				Board worker(board);
+				worker.History.reserve(worker.History.size() + depth);
+
+				Subtree subtree;
+				bool stolen = false;
+				while (NextSubtree(queues, self, subtree, stolen))
+				{
+					for (int8 idx = 0; idx < subtree.Length; idx++)
+					{
+						worker.ApplyMove(subtree.Path[idx]);
+					}
+
+					int32 remaining = depth - subtree.Length;
+					stats.Nodes += cache != nullptr ? Count(worker, remaining, *cache) : Count(worker, remaining);
+					stats.Subtrees++;
+					stats.Stolen += stolen ? 1 : 0;
+
+					for (int8 idx = 0; idx < subtree.Length; idx++)
+					{
+						worker.UnmakeMove();
+					}
+				}
+
+				stats.Seconds = duration<double>(steady_clock::now() - workerStart).count();
+			};
+
+			//The calling thread is worker 0
+			std::vector<std::thread> helpers;
+			for (int32 idx = 1; idx < threads; idx++)
+			{
+				helpers.emplace_back(work, idx);
+			}
+
+			work(0);
+			for (std::thread& helper : helpers)
+			{
+				helper.join();
+			}
+
+			for (const WorkerStats& stats : result.Workers)
+			{
+				result.Nodes += stats.Nodes;
+			}
+
+			result.Seconds = duration<double>(steady_clock::now() - start).count();
+			return result;
+		}
+	}
+
+	Perft::ParallelResult Perft::ParallelCount(const Board& board, int32 depth, int32 threads)
+	{
+		return CountParallel(board, depth, threads, nullptr);
+	}
+
+	Perft::ParallelResult Perft::ParallelCount(const Board& board, int32 depth, int32 threads, PerftCache& cache)
+	{
+		return CountParallel(board, depth, threads, &cache);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+
+namespace Chess
+{
+	/*
+		Fixed size table of (position key, depth) -> leaf count, so perft only walks each transposition once. Shared by every
+		thread of a parallel count without locks. Each slot packs the depth into the low byte of the count and stores the key
+		XORed with that data, a slot whose key doesn't check out is treated as a miss. That keeps a slot torn by two threads
+		writing at once from ever being read back as a hit.
+	*/
+	class PerftCache
+	{
+	public:
+		explicit PerftCache(int32 sizeMB);
+
+		PerftCache(const PerftCache&) = delete;
+		PerftCache& operator=(const PerftCache&) = delete;
+
+		bool Probe(uint64 key, int32 depth, int64& count) const;
+		void Store(uint64 key, int32 depth, int64 count);
+
+		//Not safe while anything is counting
+		void Clear();
+
+		//Each count tallies its own probes and hits and adds them in once it's done, rather than every thread fighting over the
+		//same counters on every probe
+		void AddStats(int64 probes, int64 hits);
+
+		inline int64 GetProbes() const { return Probes.load(std::memory_order_relaxed); }
+		inline int64 GetHits() const { return Hits.load(std::memory_order_relaxed); }
+		inline double GetHitRate() const { return GetProbes() == 0 ? 0.0 : static_cast<double>(GetHits()) / GetProbes(); }
+
+	private:
+		struct Entry
+		{
+			std::atomic<uint64> Check;
+			std::atomic<uint64> Data;
+		};
+
+		std::unique_ptr<Entry[]> Entries;
+		uint64 EntryCount;
+		uint64 IndexMask;
+
+		std::atomic<int64> Probes;
+		std::atomic<int64> Hits;
+	};
+
+	namespace Perft
+	{
+		//Number of leaf nodes depth plies below the board's position
+		int64 Count(Board& board, int32 depth);
+
+		//As Count, but looks up and fills in the cache for every interior node. The cache may be shared with other threads
+		int64 Count(Board& board, int32 depth, PerftCache& cache);
+
+		//The count below each legal move, to find which move a wrong total comes from
+		std::vector<std::pair<Move, int64>> Divide(Board& board, int32 depth);
+
+		//A position from a perft suite with the leaf count expected at each listed depth
+		struct SuitePosition
+		{
+			std::string Fen;
+			std::vector<std::pair<int32, int64>> Expected;
+		};
+
+		//Reads an EPD line in the form "<fen> ;D1 20 ;D2 400 ...". False for blank lines, comments and lines with no counts
+		bool ParseSuiteLine(const std::string& line, SuitePosition& position);
+
+		struct WorkerStats
+		{
+			int64 Nodes;
+			double Seconds;
+			int32 Subtrees;
+			int32 Stolen;
+
+			inline double NodesPerSecond() const { return Seconds > 0.0 ? Nodes / Seconds : 0.0; }
+		};
+
+		struct ParallelResult
+		{
+			int64 Nodes;
+			double Seconds;
+			std::vector<WorkerStats> Workers;
+		};
+
+		/*
+			Same count as Count, split across threads. The tree is expanded a ply or two from the root into subtrees,
+			which are dealt out to per-thread queues. Each worker makes its own copy of the board and works through its
+			queue from the front, then steals from the back of the others' once it runs dry.
+		*/
+		ParallelResult ParallelCount(const Board& board, int32 depth, int32 threads);
+
+		//As ParallelCount, with every worker sharing the cache for its subtrees
+		ParallelResult ParallelCount(const Board& board, int32 depth, int32 threads, PerftCache& cache);
+	}
+}
\ No newline at end of file
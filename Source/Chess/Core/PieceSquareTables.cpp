@@ -0,0 +1,175 @@
+#include "PieceSquareTables.h"
+
+#include "Evaluation.h"
+
+namespace Chess
+{
+	namespace PieceSquare
+	{
+		namespace
+		{
+			//Bonuses for white, laid out as the board is seen from white's side: a8 first, h1 last. Indexed by piece type
+			const int8 Midgame[7][64] =
+			{
+				{},
+				//King, tucked away behind its pawns
+				{
+					-30,-40,-40,-50,-50,-40,-40,-30,
+					-30,-40,-40,-50,-50,-40,-40,-30,
+					-30,-40,-40,-50,-50,-40,-40,-30,
+					-30,-40,-40,-50,-50,-40,-40,-30,
+					-20,-30,-30,-40,-40,-30,-30,-20,
+					-10,-20,-20,-20,-20,-20,-20,-10,
+					 20, 20,  0,  0,  0,  0, 20, 20,
+					 20, 30, 10,  0,  0, 10, 30, 20,
+				},
+				//Pawn
+				{
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					 50, 50, 50, 50, 50, 50, 50, 50,
+					 10, 10, 20, 30, 30, 20, 10, 10,
+					  5,  5, 10, 25, 25, 10,  5,  5,
+					  0,  0,  0, 20, 20,  0,  0,  0,
+					  5, -5,-10,  0,  0,-10, -5,  5,
+					  5, 10, 10,-20,-20, 10, 10,  5,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+				},
+				//Knight
+				{
+					-50,-40,-30,-30,-30,-30,-40,-50,
+					-40,-20,  0,  0,  0,  0,-20,-40,
+					-30,  0, 10, 15, 15, 10,  0,-30,
+					-30,  5, 15, 20, 20, 15,  5,-30,
+					-30,  0, 15, 20, 20, 15,  0,-30,
+					-30,  5, 10, 15, 15, 10,  5,-30,
+					-40,-20,  0,  5,  5,  0,-20,-40,
+					-50,-40,-30,-30,-30,-30,-40,-50,
+				},
+				//Bishop
+				{
+					-20,-10,-10,-10,-10,-10,-10,-20,
+					-10,  0,  0,  0,  0,  0,  0,-10,
+					-10,  0,  5, 10, 10,  5,  0,-10,
+					-10,  5,  5, 10, 10,  5,  5,-10,
+					-10,  0, 10, 10, 10, 10,  0,-10,
+					-10, 10, 10, 10, 10, 10, 10,-10,
+					-10,  5,  0,  0,  0,  0,  5,-10,
+					-20,-10,-10,-10,-10,-10,-10,-20,
+				},
+				//Rook
+				{
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					  5, 10, 10, 10, 10, 10, 10,  5,
+					 -5,  0,  0,  0,  0,  0,  0, -5,
+					 -5,  0,  0,  0,  0,  0,  0, -5,
+					 -5,  0,  0,  0,  0,  0,  0, -5,
+					 -5,  0,  0,  0,  0,  0,  0, -5,
+					 -5,  0,  0,  0,  0,  0,  0, -5,
+					  0,  0,  0,  5,  5,  0,  0,  0,
+				},
+				//Queen
+				{
+					-20,-10,-10, -5, -5,-10,-10,-20,
+					-10,  0,  0,  0,  0,  0,  0,-10,
+					-10,  0,  5,  5,  5,  5,  0,-10,
+					 -5,  0,  5,  5,  5,  5,  0, -5,
+					  0,  0,  5,  5,  5,  5,  0, -5,
+					-10,  5,  5,  5,  5,  5,  0,-10,
+					-10,  0,  5,  0,  0,  0,  0,-10,
+					-20,-10,-10, -5, -5,-10,-10,-20,
+				},
+			};
+
+			//Only the king and pawns change their minds much once the board empties out
+			const int8 Endgame[7][64] =
+			{
+				{},
+				//King, out in the centre where it can help
+				{
+					-50,-40,-30,-20,-20,-30,-40,-50,
+					-30,-20,-10,  0,  0,-10,-20,-30,
+					-30,-10, 20, 30, 30, 20,-10,-30,
+					-30,-10, 30, 40, 40, 30,-10,-30,
+					-30,-10, 30, 40, 40, 30,-10,-30,
+					-30,-10, 20, 30, 30, 20,-10,-30,
+					-30,-30,  0,  0,  0,  0,-30,-30,
+					-50,-30,-30,-30,-30,-30,-30,-50,
+				},
+				//Pawn, worth more the closer it is to promoting
+				{
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					 80, 80, 80, 80, 80, 80, 80, 80,
+					 50, 50, 50, 50, 50, 50, 50, 50,
+					 30, 30, 30, 30, 30, 30, 30, 30,
+					 20, 20, 20, 20, 20, 20, 20, 20,
+					 10, 10, 10, 10, 10, 10, 10, 10,
+					 10, 10, 10, 10, 10, 10, 10, 10,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+				},
+				//Knight
+				{
+					-50,-40,-30,-30,-30,-30,-40,-50,
+					-40,-20,  0,  0,  0,  0,-20,-40,
+					-30,  0, 10, 15, 15, 10,  0,-30,
+					-30,  5, 15, 20, 20, 15,  5,-30,
+					-30,  0, 15, 20, 20, 15,  0,-30,
+					-30,  5, 10, 15, 15, 10,  5,-30,
+					-40,-20,  0,  5,  5,  0,-20,-40,
+					-50,-40,-30,-30,-30,-30,-40,-50,
+				},
+				//Bishop
+				{
+					-20,-10,-10,-10,-10,-10,-10,-20,
+					-10,  0,  0,  0,  0,  0,  0,-10,
+					-10,  0,  5, 10, 10,  5,  0,-10,
+					-10,  5,  5, 10, 10,  5,  5,-10,
+					-10,  0, 10, 10, 10, 10,  0,-10,
+					-10, 10, 10, 10, 10, 10, 10,-10,
+					-10,  5,  0,  0,  0,  0,  5,-10,
+					-20,-10,-10,-10,-10,-10,-10,-20,
+				},
+				//Rook
+				{
+					  5,  5,  5,  5,  5,  5,  5,  5,
+					 10, 10, 10, 10, 10, 10, 10, 10,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+					  0,  0,  0,  0,  0,  0,  0,  0,
+				},
+				//Queen
+				{
+					-20,-10,-10, -5, -5,-10,-10,-20,
+					-10,  0,  0,  0,  0,  0,  0,-10,
+					-10,  0,  5,  5,  5,  5,  0,-10,
+					 -5,  0,  5,  5,  5,  5,  0, -5,
+					 -5,  0,  5,  5,  5,  5,  0, -5,
+					-10,  0,  5,  5,  5,  5,  0,-10,
+					-10,  0,  0,  0,  0,  0,  0,-10,
+					-20,-10,-10, -5, -5,-10,-10,-20,
+				},
+			};
+		}
+
+		const Tables PieceSquareTables;
+
+		Tables::Tables()
+		{
+			for (int8 type = 0; type < 7; type++)
+			{
+				for (int8 square = 0; square < 64; square++)
+				{
+					//The tables list a8 first so white's squares are found by flipping the rank. Black sees the board upside
+					//down from white, so its squares index the same tables directly
+					int8 whiteIdx = square ^ 56;
+					int8 blackIdx = square;
+
+					Pieces[0][type][square] = MakeScore(Evaluation::PieceValues[type] + Midgame[type][whiteIdx], Evaluation::EndgamePieceValues[type] + Endgame[type][whiteIdx]);
+					Pieces[1][type][square] = -MakeScore(Evaluation::PieceValues[type] + Midgame[type][blackIdx], Evaluation::EndgamePieceValues[type] + Endgame[type][blackIdx]);
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Constants.h"
+#include "Utils.h"
+
+namespace Chess
+{
+	namespace PieceSquare
+	{
+		//A midgame and an endgame score packed into one int, so both are kept up to date with a single add. The endgame half
+		//sits in the high 16 bits, and borrows from it when the midgame half is negative, which unpacking puts back
+		typedef int32 Score;
+
+		inline Score MakeScore(int32 midgame, int32 endgame) { return static_cast<Score>(static_cast<uint32>(endgame) << 16) + midgame; }
+		inline int32 MidgameScore(Score score) { return static_cast<int16>(static_cast<uint16>(static_cast<uint32>(score))); }
+		inline int32 EndgameScore(Score score) { return static_cast<int16>(static_cast<uint16>((static_cast<uint32>(score) + 0x8000) >> 16)); }
+
+		//How much each piece type counts towards the game still being in its midgame, indexed by piece type. With every
+		//piece but the pawns and kings on the board the phase is MaxPhase, it falls to nothing as they come off
+		const int32 PhaseWeights[7] = { 0, 0, 0, 1, 1, 2, 4 };
+		const int32 MaxPhase = 24;
+
+		/*
+			Material plus position of every piece on every square, from white's point of view so black's scores are negative.
+			There is a single instance, built during static initialisation from the tables in the .cpp and only read afterwards.
+		*/
+		struct Tables
+		{
+		public:
+			Tables();
+
+			//Indexed by colour index, piece type and square
+			Score Pieces[2][7][64];
+		};
+
+		extern const Tables PieceSquareTables;
+
+		inline Score PieceScore(int8 piece, int8 square)
+		{
+			return PieceSquareTables.Pieces[Utils::ColourIndex(piece)][Utils::GetType(piece)][square];
+		}
+
+		inline int32 PiecePhase(int8 piece)
+		{
+			return PhaseWeights[Utils::GetType(piece)];
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,417 @@
+#include "Search.h"
+
+#include "Evaluation.h"
+#include "MoveGeneration.h"
+#include "MoveList.h"
+#include "MovePicker.h"
+#include "Nnue.h"
+
+#include <thread>
+
+namespace Chess
+{
+	using namespace Search;
+
+	namespace
+	{
+		//How many nodes go by between looking at the stop flag and node limit
+		const int64 CheckInterval = 1024;
+
+		//Which depths each helper skips, cycling through the patterns by helper index. A helper skips a depth when
+		//(depth + phase) / size is odd, so helpers alternate between the depths the main thread is on and the next ones
+		const int32 SkipPatterns = 20;
+		const int32 SkipSize[SkipPatterns] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+		const int32 SkipPhase[SkipPatterns] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+	}
+
+	Searcher::Searcher(TranspositionTable& table, int32 helperIndex /*= 0*/) :
+		Table(table), HelperIndex(helperIndex), Stopped(false), Nodes(0), MaxNodes(0), Deadline(0), PreviousVariationLength(0)
+	{
+		memset(PrincipalVariationLength, 0, sizeof(PrincipalVariationLength));
+	}
+
+	Search::Result Searcher::Run(Board& board, const Limits& limits, const IterationCallback& onIteration /*= nullptr*/)
+	{
+		if (HelperIndex == 0)
+		{
+			ClearStop();
+		}
+
+		Nodes = 0;
+		MaxNodes = limits.MaxNodes;
+		SetTimeLimit(limits.MaxMilliseconds);
+		PreviousVariationLength = 0;
+
+		//Killers are about particular positions, which a new search mostly won't reach. History is about moves in general
+		std::fill(&Killers[0][0], &Killers[0][0] + MaxPly * MoveOrdering::KillerSlots, Move());
+		History.Age();
+
+		//Helpers are part of the main thread's search, only it ages the table
+		if (HelperIndex == 0)
+		{
+			Table.NewSearch();
+		}
+
+		Result result;
+
+		//Something legal to play even if the first iteration doesn't finish
+		MoveList rootMoves;
+		MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove(), rootMoves);
+		if (rootMoves.IsEmpty())
+		{
+			result.Score = MoveGeneration::CalculateKingSafety(board.BoardState, board.GetColourToMove()).Checkers != Bitboard::Empty ? -Mate : Draw;
+			return result;
+		}
+
+		result.BestMove = rootMoves[0];
+
+		int32 maxDepth = std::min(limits.MaxDepth, MaxPly - 1);
+		for (int32 depth = 1; depth <= maxDepth; depth++)
+		{
+			if (HelperIndex > 0 && depth > 1)
+			{
+				int32 pattern = (HelperIndex - 1) % SkipPatterns;
+				if (((depth + SkipPhase[pattern]) / SkipSize[pattern]) % 2 != 0)
+				{
+					continue;
+				}
+			}
+
+			int32 score = Negamax(board, depth, 0, -Infinity, Infinity, true);
+
+			//A part searched iteration can't be trusted, it may not have looked at the move that refutes its best one
+			if (IsStopped())
+			{
+				break;
+			}
+
+			result.Score = score;
+			result.Depth = depth;
+			result.Nodes = Nodes;
+			result.HashFull = Table.HashFull();
+			result.BestMove = PrincipalVariation[0][0];
+			result.PrincipalVariation.assign(PrincipalVariation[0], PrincipalVariation[0] + PrincipalVariationLength[0]);
+
+			std::copy(PrincipalVariation[0], PrincipalVariation[0] + PrincipalVariationLength[0], PreviousVariation);
+			PreviousVariationLength = PrincipalVariationLength[0];
+
+			if (onIteration)
+			{
+				onIteration(result);
+			}
+
+			//Searching deeper can't find a faster mate than one already found with every reply considered
+			if (IsMateScore(score) && Mate - std::abs(score) <= depth)
+			{
+				break;
+			}
+		}
+
+		result.Nodes = Nodes;
+		return result;
+	}
+
+	int32 Searcher::Negamax(Board& board, int32 depth, int32 ply, int32 alpha, int32 beta, bool onPrincipalVariation)
+	{
+		PrincipalVariationLength[ply] = 0;
+
+		if (ply > 0 && (board.BoardState.HalfMoveClock >= 100 || IsRepetition(board)))
+		{
+			return Draw;
+		}
+
+		if (depth <= 0)
+		{
+			return Quiescence(board, ply, alpha, beta);
+		}
+
+		if (!VisitNode())
+		{
+			return 0;
+		}
+
+		if (ply >= MaxPly - 1)
+		{
+			return Evaluate(board);
+		}
+
+		//A deep enough result from before settles the node, unless it's the root which has to come up with a move of its own
+		TableEntry entry;
+		Move hashMove;
+		if (Table.Probe(board.GetKey(), entry))
+		{
+			hashMove = entry.BestMove;
+
+			int32 score = ScoreFromTable(entry.Score, ply);
+			if (ply > 0 && entry.Depth >= depth &&
+				(entry.Bound == Bound::Exact || (entry.Bound == Bound::Lower && score >= beta) || (entry.Bound == Bound::Upper && score <= alpha)))
+			{
+				return score;
+			}
+		}
+
+		//Follow the last iteration's best line first, it's the most likely to be best again
+		if (onPrincipalVariation && ply < PreviousVariationLength)
+		{
+			hashMove = PreviousVariation[ply];
+		}
+
+		MovePicker picker(board.BoardState, hashMove, Killers[ply], History);
+		int8 colour = board.GetColourToMove();
+
+		int32 originalAlpha = alpha;
+		int32 bestScore = -Infinity;
+		Move bestMove;
+		int32 movesSearched = 0;
+		MoveList quietsSearched;
+		Move move;
+		while (picker.Next(move))
+		{
+			board.ApplyMove(move);
+			int32 score = -Negamax(board, depth - 1, ply + 1, -beta, -alpha, onPrincipalVariation && move == hashMove);
+			board.UnmakeMove();
+			movesSearched++;
+
+			if (IsStopped())
+			{
+				return 0;
+			}
+
+			if (score > bestScore)
+			{
+				bestScore = score;
+				bestMove = move;
+				if (score > alpha)
+				{
+					alpha = score;
+					UpdatePrincipalVariation(ply, move);
+
+					if (alpha >= beta)
+					{
+						if (!move.IsCapture() && !move.IsPromotion())
+						{
+							UpdateQuietCutoff(colour, ply, depth, move, quietsSearched);
+						}
+
+						break;
+					}
+				}
+			}
+
+			if (!move.IsCapture() && !move.IsPromotion())
+			{
+				quietsSearched.Add(move);
+			}
+		}
+
+		if (movesSearched == 0)
+		{
+			return picker.IsInCheck() ? -Mate + ply : Draw;
+		}
+
+		//Only a move that raised alpha is known to be best, when everything failed low there's nothing to say which was
+		uint8 bound = bestScore >= beta ? Bound::Lower : bestScore > originalAlpha ? Bound::Exact : Bound::Upper;
+		Table.Store(board.GetKey(), depth, bound, ScoreToTable(bestScore, ply), bound == Bound::Upper ? Move() : bestMove);
+
+		return bestScore;
+	}
+
+	int32 Searcher::Quiescence(Board& board, int32 ply, int32 alpha, int32 beta)
+	{
+		PrincipalVariationLength[ply] = 0;
+
+		if (!VisitNode())
+		{
+			return 0;
+		}
+
+		MovePicker picker(board.BoardState, History);
+		bool inCheck = picker.IsInCheck();
+
+		if (ply >= MaxPly - 1)
+		{
+			return Evaluate(board);
+		}
+
+		//Standing pat isn't an option in check, every evasion has to be looked at instead
+		int32 bestScore = -Infinity;
+		if (!inCheck)
+		{
+			bestScore = Evaluate(board);
+			if (bestScore >= beta)
+			{
+				return bestScore;
+			}
+
+			alpha = std::max(alpha, bestScore);
+		}
+
+		int32 movesSearched = 0;
+		Move move;
+		while (picker.Next(move))
+		{
+			board.ApplyMove(move);
+			int32 score = -Quiescence(board, ply + 1, -beta, -alpha);
+			board.UnmakeMove();
+			movesSearched++;
+
+			if (IsStopped())
+			{
+				return 0;
+			}
+
+			if (score > bestScore)
+			{
+				bestScore = score;
+				if (score > alpha)
+				{
+					alpha = score;
+					UpdatePrincipalVariation(ply, move);
+
+					if (alpha >= beta)
+					{
+						break;
+					}
+				}
+			}
+		}
+
+		if (inCheck && movesSearched == 0)
+		{
+			return -Mate + ply;
+		}
+
+		return bestScore;
+	}
+
+	bool Searcher::VisitNode()
+	{
+		Nodes++;
+		if (Nodes % CheckInterval == 0 &&
+			((MaxNodes > 0 && Nodes >= MaxNodes) || IsPastDeadline()))
+		{
+			Stop();
+		}
+
+		return !IsStopped();
+	}
+
+	int32 Searcher::Evaluate(Board& board)
+	{
+		return board.GetNetwork() != nullptr ? Nnue::Evaluate(board) : Evaluation::Evaluate(board.BoardState, Pawns);
+	}
+
+	void Searcher::SetTimeLimit(int64 milliseconds)
+	{
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+		Deadline.store(milliseconds > 0 ? deadline.time_since_epoch().count() : 0, std::memory_order_relaxed);
+	}
+
+	bool Searcher::IsPastDeadline() const
+	{
+		std::chrono::steady_clock::rep deadline = Deadline.load(std::memory_order_relaxed);
+		return deadline != 0 && std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+	}
+
+	bool Searcher::IsRepetition(const Board& board)
+	{
+		//Only positions since the last capture or pawn move can repeat, and only every other one has the same side to move
+		int32 ply = board.GetPly();
+		int32 earliest = std::max(ply - static_cast<int32>(board.BoardState.HalfMoveClock), 0);
+		for (int32 idx = ply - 2; idx >= earliest; idx -= 2)
+		{
+			if (board.History[idx].Key == board.GetKey())
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void Searcher::UpdatePrincipalVariation(int32 ply, const Move& move)
+	{
+		PrincipalVariation[ply][ply] = move;
+
+		int32 childLength = PrincipalVariationLength[ply + 1];
+		std::copy(PrincipalVariation[ply + 1] + ply + 1, PrincipalVariation[ply + 1] + ply + 1 + childLength, PrincipalVariation[ply] + ply + 1);
+		PrincipalVariationLength[ply] = childLength + 1;
+	}
+
+	void Searcher::UpdateQuietCutoff(int8 colour, int32 ply, int32 depth, const Move& move, const MoveList& quietsSearched)
+	{
+		if (Killers[ply][0] != move)
+		{
+			std::copy_backward(Killers[ply], Killers[ply] + MoveOrdering::KillerSlots - 1, Killers[ply] + MoveOrdering::KillerSlots);
+			Killers[ply][0] = move;
+		}
+
+		History.Reward(colour, move, depth);
+		for (const Move& quiet : quietsSearched)
+		{
+			History.Penalise(colour, quiet, depth);
+		}
+	}
+
+	ParallelSearcher::ParallelSearcher(TranspositionTable& table, int32 threads)
+	{
+		for (int32 idx = 0; idx < std::max(threads, 1); idx++)
+		{
+			Searchers.emplace_back(new Searcher(table, idx));
+		}
+	}
+
+	Search::Result ParallelSearcher::Run(Board& board, const Limits& limits, const Searcher::IterationCallback& onIteration /*= nullptr*/)
+	{
+		//Helpers search until the main thread is done, however deep that takes them
+		Limits helperLimits;
+		helperLimits.MaxDepth = limits.MaxDepth;
+
+		//Every copy is taken before anything starts searching, the main thread's board changes under them once it does
+		std::vector<Board> helperBoards(Searchers.size() - 1, board);
+
+		//Likewise the stop flags, the main thread can finish and stop everything before a helper's thread has even started
+		for (size_t idx = 1; idx < Searchers.size(); idx++)
+		{
+			Searchers[idx]->ClearStop();
+		}
+
+		std::vector<std::thread> helpers;
+		for (size_t idx = 1; idx < Searchers.size(); idx++)
+		{
+			helpers.emplace_back([this, idx, &helperBoards, &helperLimits]()
+			{
+				Searchers[idx]->Run(helperBoards[idx - 1], helperLimits);
+			});
+		}
+
+		Result result = Searchers[0]->Run(board, limits, onIteration);
+
+		Stop();
+		for (std::thread& helper : helpers)
+		{
+			helper.join();
+		}
+
+		for (size_t idx = 1; idx < Searchers.size(); idx++)
+		{
+			result.Nodes += Searchers[idx]->GetNodes();
+		}
+
+		return result;
+	}
+
+	void ParallelSearcher::Stop()
+	{
+		for (const std::unique_ptr<Searcher>& searcher : Searchers)
+		{
+			searcher->Stop();
+		}
+	}
+
+	void ParallelSearcher::SetTimeLimit(int64 milliseconds)
+	{
+		//The helpers stop when the main thread does
+		Searchers[0]->SetTimeLimit(milliseconds);
+	}
+}
\ No newline at end of file
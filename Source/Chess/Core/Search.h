@@ -0,0 +1,156 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Board.h"
+#include "Move.h"
+#include "MoveList.h"
+#include "MoveOrdering.h"
+#include "PawnTable.h"
+#include "TranspositionTable.h"
+
+namespace Chess
+{
+	namespace Search
+	{
+		//Scores are in centipawns from the side to move's point of view. Mates are scored as Mate less the plies to reach them
+		const int32 Infinity = 32000;
+		const int32 Mate = 31000;
+		const int32 Draw = 0;
+
+		//Deepest a search can reach, quiescence included
+		const int32 MaxPly = 128;
+
+		inline bool IsMateScore(int32 score) { return score >= Mate - MaxPly || score <= -Mate + MaxPly; }
+
+		//Mate scores count plies from the root, the table stores them counted from the position itself so they hold wherever it's reached
+		inline int32 ScoreToTable(int32 score, int32 ply) { return score >= Mate - MaxPly ? score + ply : score <= -Mate + MaxPly ? score - ply : score; }
+		inline int32 ScoreFromTable(int32 score, int32 ply) { return score >= Mate - MaxPly ? score - ply : score <= -Mate + MaxPly ? score + ply : score; }
+
+		struct Limits
+		{
+			int32 MaxDepth = MaxPly - 1;
+
+			//Zero for no limit
+			int64 MaxNodes = 0;
+			int64 MaxMilliseconds = 0;
+		};
+
+		struct Result
+		{
+			Move BestMove;
+			int32 Score = 0;
+
+			//Last depth searched to completion
+			int32 Depth = 0;
+			int64 Nodes = 0;
+
+			//Permille of the transposition table in use
+			int32 HashFull = 0;
+
+			std::vector<Move> PrincipalVariation;
+		};
+	}
+
+	/*
+		Negamax alpha-beta with iterative deepening and a quiescence search over captures at the leaves. Each iteration tries the
+		previous iteration's principal variation first, and the transposition table's best move everywhere else, then leaves the
+		rest to the move picker's capture, killer and history ordering. Search stops at the depth, node or time limit, or as soon as possible after Stop
+		is called from any thread, returning the result of the last iteration it finished.
+	*/
+	class Searcher
+	{
+	public:
+		//The table can be shared with other searchers, it's only ever touched through its lock-free probes and stores.
+		//Helpers (any index but 0) skip some depths so a group of them searching the same position spread out over the tree
+		explicit Searcher(TranspositionTable& table, int32 helperIndex = 0);
+
+		typedef std::function<void(const Search::Result&)> IterationCallback;
+
+		//The board is searched in place and left as it was found. The callback, if any, is called after each finished iteration.
+		//The main searcher clears its stop flag as it starts, a helper leaves it to its owner to call ClearStop beforehand, so
+		//a stop that lands before the helper's thread gets going isn't lost
+		Search::Result Run(Board& board, const Search::Limits& limits, const IterationCallback& onIteration = nullptr);
+
+		inline void Stop() { Stopped.store(true, std::memory_order_relaxed); }
+		inline void ClearStop() { Stopped.store(false, std::memory_order_relaxed); }
+		inline bool IsStopped() const { return Stopped.load(std::memory_order_relaxed); }
+
+		//Gives the running search a time limit counting from now, or takes it away with zero. Safe to call from any thread, but
+		//a search that hasn't started yet sets its own from its limits when it does
+		void SetTimeLimit(int64 milliseconds);
+
+		//Nodes visited by the last or current search, only safe to read from another thread once the search is done
+		inline int64 GetNodes() const { return Nodes; }
+		inline const PawnTable& GetPawnTable() const { return Pawns; }
+
+	private:
+		int32 Negamax(Board& board, int32 depth, int32 ply, int32 alpha, int32 beta, bool onPrincipalVariation);
+		int32 Quiescence(Board& board, int32 ply, int32 alpha, int32 beta);
+
+		//Counts the node, and checks the limits every so often
+		bool VisitNode();
+
+		//With the board's network if it has one, otherwise the hand written evaluation
+		int32 Evaluate(Board& board);
+		bool IsPastDeadline() const;
+		static bool IsRepetition(const Board& board);
+		void UpdatePrincipalVariation(int32 ply, const Move& move);
+
+		//After a quiet move causes a cutoff: it becomes the ply's newest killer, and gains history while the quiet moves
+		//searched before it lose some
+		void UpdateQuietCutoff(int8 colour, int32 ply, int32 depth, const Move& move, const MoveList& quietsSearched);
+
+		TranspositionTable& Table;
+		int32 HelperIndex;
+
+		//Every thread has its own, they're too small and too often hit to be worth sharing
+		PawnTable Pawns;
+
+		//Move ordering, learned as the search goes and kept per thread like the pawn table
+		Move Killers[Search::MaxPly][MoveOrdering::KillerSlots];
+		MoveOrdering::ButterflyHistory History;
+
+		std::atomic<bool> Stopped;
+		int64 Nodes;
+		int64 MaxNodes;
+		//Steady clock ticks to stop at, zero for none
+		std::atomic<std::chrono::steady_clock::rep> Deadline;
+
+		//Triangular table, the variation found from each ply is stored starting at that ply's own index
+		Move PrincipalVariation[Search::MaxPly][Search::MaxPly];
+		int32 PrincipalVariationLength[Search::MaxPly];
+
+		Move PreviousVariation[Search::MaxPly];
+		int32 PreviousVariationLength;
+	};
+
+	/*
+		Lazy SMP: every thread searches the same root with its own Searcher and copy of the board, sharing nothing but the
+		transposition table. What one thread stores steers the others into different parts of the tree, and helpers skipping
+		depths spreads them further. The calling thread runs the main search and its result is the one returned.
+	*/
+	class ParallelSearcher
+	{
+	public:
+		ParallelSearcher(TranspositionTable& table, int32 threads);
+
+		//As Searcher::Run. The callback is only called for the main thread's iterations, and the node and time limits apply to
+		//the main thread alone, the helpers stop with it. Nodes in the result are the total over every thread
+		Search::Result Run(Board& board, const Search::Limits& limits, const Searcher::IterationCallback& onIteration = nullptr);
+
+		//Safe to call from any thread
+		void Stop();
+		void SetTimeLimit(int64 milliseconds);
+
+		inline int32 GetThreadCount() const { return static_cast<int32>(Searchers.size()); }
+
+	private:
+		std::vector<std::unique_ptr<Searcher>> Searchers;
+	};
+}
\ No newline at end of file
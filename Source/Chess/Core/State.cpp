@@ -1,17 +1,24 @@
 #include "State.h"
 #include <assert.h>
 #include <cctype>
+#include <sstream>
 
+#include "Attacks.h"
 #include "Utils.h"
+#include "Zobrist.h"
 
 namespace Chess
 {
 	using namespace Constants;
+	using namespace Zobrist;
 
 	State::State(const std::string& fen) :
-		WhiteThreatMap(Piece::White), BlackThreatMap(Piece::Black)
+		ColourToMove(Piece::White), WhiteCastleAvailable(Castling::None), BlackCastleAvailable(Castling::None), EnPassentTarget(NO_EN_PASSENT),
+		HalfMoveClock(0), FullMoveNumber(1), Occupancy(Bitboard::Empty), KingSquares{ DEFAULT, DEFAULT }, Key(0), PawnKey(0), PieceSquareScore(0), Phase(0), WhiteThreatMap(Piece::White), BlackThreatMap(Piece::Black)
 	{
 		memset(Squares, 0, 64);
+		memset(PieceBitboards, 0, sizeof(PieceBitboards));
+		memset(ColourBitboards, 0, sizeof(ColourBitboards));
 
 		size_t endOfBoard = fen.find(' ');
 		if (endOfBoard != std::string::npos)
@@ -31,13 +38,13 @@ namespace Chess
 				{
 					if (std::isdigit(symbol))
 					{
-						file += std::atoi(&symbol);
+						file += symbol - '0';
 					}
 					else
 					{
 						int colour = std::isupper(symbol) ? Piece::White : Piece::Black;
 						int piece = PieceTypeFromSymbol.at(static_cast<char>(std::tolower(symbol)));
-						Squares[rank * 8 + file] = colour | piece;
+						PutPiece(rank * 8 + file, colour | piece);
 						file++;
 					}
 				}
@@ -62,103 +69,460 @@ namespace Chess
 			WhiteCastleAvailable = castling.find("K") != std::string::npos ? Castling::Kingside : Castling::None;
 			WhiteCastleAvailable |= castling.find("Q") != std::string::npos ? Castling::Queenside : Castling::None;
 
-			//Not currently being used
 			size_t endOfEP = fen.find(' ', endOfCastling + 1);
 			std::string enPassent = fen.substr(endOfCastling + 1, endOfEP - (endOfCastling + 1));
+			if (enPassent.size() == 2)
+			{
+				EnPassentTarget = Utils::SquareFromName(enPassent.c_str());
+			}
 
-			size_t endOfHM = fen.find(' ', endOfEP + 1);
-			int8 HalfMoveCounter = std::atoi(fen.substr(endOfEP + 1, endOfHM - (endOfEP + 1)).c_str());
+			//The move counters are optional, EPD positions leave them off
+			if (endOfEP != std::string::npos)
+			{
+				size_t endOfHM = fen.find(' ', endOfEP + 1);
+				HalfMoveClock = std::atoi(fen.substr(endOfEP + 1, endOfHM - (endOfEP + 1)).c_str());
 
-			size_t endOfFM = fen.find(' ', endOfHM + 1);
-			int8 FullMoveCounter = std::atoi(fen.substr(endOfHM + 1, endOfFM - (endOfHM + 1)).c_str());
+				if (endOfHM != std::string::npos)
+				{
+					size_t endOfFM = fen.find(' ', endOfHM + 1);
+					FullMoveNumber = std::atoi(fen.substr(endOfHM + 1, endOfFM - (endOfHM + 1)).c_str());
+				}
+			}
 		}
 
+		Key = ComputeKey();
 		UpdateThreatMaps();
 	}
 
-	void State::Update(const Move& move)
+	bool State::IsValidFEN(const std::string& fen, std::string& error)
 	{
-		Squares[move.TargetSquare] = Squares[move.StartSquare];
-		Squares[move.StartSquare] = 0;
-
-		if (move.PreventsCastling != Castling::None)
+		std::istringstream fields(fen);
+		std::string board, toPlay, castling, enPassent, halfMove, fullMove;
+		if (!(fields >> board >> toPlay >> castling >> enPassent))
 		{
-			int8& updateCastling = Utils::IsColour(move.Colour, Piece::White) ? WhiteCastleAvailable : BlackCastleAvailable;
-			updateCastling &= ~move.PreventsCastling;
+			error = "expected at least the board, side to move, castling and en passent fields";
+			return false;
 		}
 
-		if (move.SecondaryStart != -1)
+		int32 kings[2] = { 0, 0 };
+		int32 rank = 7;
+		int32 file = 0;
+		for (char symbol : board)
 		{
-			if (move.SecondaryTarget != -1) //Target is -1 in case of en passent, a real value in the case of castling
+			if (symbol == '/')
 			{
-				Squares[move.SecondaryTarget] = Squares[move.SecondaryStart];
+				if (file != 8 || rank == 0)
+				{
+					error = rank == 0 ? "more than eight ranks" : "rank " + std::to_string(rank + 1) + " isn't eight squares";
+					return false;
+				}
+
+				file = 0;
+				rank--;
 			}
+			else if (symbol >= '1' && symbol <= '8')
+			{
+				file += symbol - '0';
+			}
+			else if (PieceTypeFromSymbol.count(static_cast<char>(std::tolower(symbol))) != 0)
+			{
+				int8 type = PieceTypeFromSymbol.at(static_cast<char>(std::tolower(symbol)));
+				if (type == Piece::King)
+				{
+					kings[std::isupper(symbol) ? 0 : 1]++;
+				}
+				else if (type == Piece::Pawn && (rank == 0 || rank == 7))
+				{
+					error = "pawn on rank " + std::to_string(rank + 1);
+					return false;
+				}
 
-			Squares[move.SecondaryStart] = 0;
+				file++;
+			}
+			else
+			{
+				error = std::string("unknown piece '") + symbol + "'";
+				return false;
+			}
+
+			if (file > 8)
+			{
+				error = "rank " + std::to_string(rank + 1) + " isn't eight squares";
+				return false;
+			}
+		}
+
+		if (rank != 0 || file != 8)
+		{
+			error = "the board isn't eight ranks of eight squares";
+			return false;
 		}
 
-		if (move.Promote != Piece::None)
+		if (kings[0] != 1 || kings[1] != 1)
 		{
-			Squares[move.TargetSquare] = ColourToMove | move.Promote;
+			error = "each side needs exactly one king";
+			return false;
 		}
 
-		EnPassentTarget = move.EnPassentTarget;
+		if (toPlay != "w" && toPlay != "b")
+		{
+			error = "side to move must be w or b";
+			return false;
+		}
 
-		UpdateThreatMaps();
+		if (castling != "-" && castling.find_first_not_of("KQkq") != std::string::npos)
+		{
+			error = "castling must be - or some of KQkq";
+			return false;
+		}
+
+		char enPassentRank = toPlay == "w" ? '6' : '3';
+		if (enPassent != "-" && (enPassent.size() != 2 || enPassent[0] < 'a' || enPassent[0] > 'h' || enPassent[1] != enPassentRank))
+		{
+			error = "en passent target must be - or a square on rank " + std::string(1, enPassentRank);
+			return false;
+		}
+
+		if ((fields >> halfMove && halfMove.find_first_not_of("0123456789") != std::string::npos) ||
+			(fields >> fullMove && fullMove.find_first_not_of("0123456789") != std::string::npos))
+		{
+			error = "move counters must be numbers";
+			return false;
+		}
+
+		//Only safe to set up now the board is known to be sound. Moving into a position where the king can be taken would
+		//leave the side to move able to capture it
+		State state(fen);
+		int8 waiting = state.ColourToMove == Piece::White ? Piece::Black : Piece::White;
+		if (state.IsKingThreatened(waiting))
+		{
+			error = "the side not to move is in check";
+			return false;
+		}
+
+		return true;
+	}
+
+	UndoRecord State::Update(const Move& move)
+	{
+		int8 start = move.StartSquare();
+		int8 target = move.TargetSquare();
+		int8 movingPiece = Squares[start];
+
+		UndoRecord undo;
+		undo.MoveMade = move;
+		undo.CapturedPiece = Squares[move.IsEnPassentCapture() ? move.SecondaryStart() : target];
+		undo.WhiteCastleAvailable = WhiteCastleAvailable;
+		undo.BlackCastleAvailable = BlackCastleAvailable;
+		undo.EnPassentTarget = EnPassentTarget;
+		undo.HalfMoveClock = HalfMoveClock;
+		undo.Key = Key;
+		undo.WhiteThreats = WhiteThreatMap.GetMap();
+		undo.BlackThreats = BlackThreatMap.GetMap();
+		undo.SavedAttackCount = 0;
+
+		if (move.IsEnPassentCapture())
+		{
+			RemovePiece(move.SecondaryStart());
+		}
+
+		RemovePiece(start);
+		RemovePiece(target);
+		PutPiece(target, move.IsPromotion() ? ColourToMove | move.Promote() : movingPiece);
+
+		if (move.Castle() != Castling::None)
+		{
+			int8 rook = Squares[move.SecondaryStart()];
+			RemovePiece(move.SecondaryStart());
+			PutPiece(move.SecondaryTarget(), rook);
+		}
+
+		//Anything moving off or onto a king or rook's home square removes the castling rights that depend on it
+		Key ^= CastlingKey(WhiteCastleAvailable, BlackCastleAvailable) ^ EnPassentKey(EnPassentTarget);
+		RevokeCastling(start);
+		RevokeCastling(target);
+
+		EnPassentTarget = move.EnPassentTarget();
+		Key ^= CastlingKey(WhiteCastleAvailable, BlackCastleAvailable) ^ EnPassentKey(EnPassentTarget) ^ ZobristKeys.BlackToMove;
+
+		bool resetsClock = undo.CapturedPiece != Piece::None || Utils::IsType(movingPiece, Piece::Pawn);
+		HalfMoveClock = resetsClock ? 0 : HalfMoveClock + 1;
+		if (ColourToMove == Piece::Black)
+		{
+			FullMoveNumber++;
+		}
+
+		//The mover's own attacks always change, the opponent's only when it lost a piece or one of its sliders was blocked or opened up
+		int8 moverIdx = Utils::ColourIndex(ColourToMove);
+		uint64 refreshed = RefreshAttacks(TouchedSquares(move), &undo);
+		CombineAttacks(moverIdx);
+		if (undo.CapturedPiece != Piece::None || (refreshed & ColourBitboards[moverIdx ^ 1]) != Bitboard::Empty)
+		{
+			CombineAttacks(moverIdx ^ 1);
+		}
 
 		ColourToMove = ColourToMove == Piece::White ? Piece::Black : Piece::White;
+
+		return undo;
 	}
 
-	void State::UpdateThreatMaps()
+	void State::Revert(const UndoRecord& undo)
 	{
-		WhiteThreatMap.CalculateMap(*this);
-		BlackThreatMap.CalculateMap(*this);
+		const Move& move = undo.MoveMade;
+		int8 start = move.StartSquare();
+		int8 target = move.TargetSquare();
+
+		ColourToMove = ColourToMove == Piece::White ? Piece::Black : Piece::White;
+		if (ColourToMove == Piece::Black)
+		{
+			FullMoveNumber--;
+		}
+
+		if (move.Castle() != Castling::None)
+		{
+			int8 rook = Squares[move.SecondaryTarget()];
+			RemovePiece(move.SecondaryTarget());
+			PutPiece(move.SecondaryStart(), rook);
+		}
+
+		int8 movedPiece = move.IsPromotion() ? ColourToMove | Piece::Pawn : Squares[target];
+		RemovePiece(target);
+		PutPiece(start, movedPiece);
+
+		if (undo.CapturedPiece != Piece::None)
+		{
+			PutPiece(move.IsEnPassentCapture() ? move.SecondaryStart() : target, undo.CapturedPiece);
+		}
+
+		WhiteCastleAvailable = undo.WhiteCastleAvailable;
+		BlackCastleAvailable = undo.BlackCastleAvailable;
+		EnPassentTarget = undo.EnPassentTarget;
+		HalfMoveClock = undo.HalfMoveClock;
+		Key = undo.Key;
+
+		if (undo.SavedAttackCount <= UndoRecord::MaxSavedAttacks)
+		{
+			for (int8 idx = undo.SavedAttackCount - 1; idx >= 0; idx--)
+			{
+				AttacksFrom[undo.SavedAttackSquares[idx]] = undo.SavedAttacks[idx];
+			}
+		}
+		else
+		{
+			RefreshAttacks(TouchedSquares(move));
+		}
+
+		WhiteThreatMap.SetMap(undo.WhiteThreats);
+		BlackThreatMap.SetMap(undo.BlackThreats);
 	}
 
-	bool State::IsSquareThreatened(int8 square, int8 friendlyColour) const
+	uint64 State::TouchedSquares(const Move& move)
 	{
-		const ThreatMap& threats = Utils::IsColour(friendlyColour, Constants::Piece::White) ? BlackThreatMap : WhiteThreatMap;
-		return threats.IsThreatened(square);
+		uint64 touched = Bitboard::SquareMask(move.StartSquare()) | Bitboard::SquareMask(move.TargetSquare());
+		if (move.SecondaryStart() != DEFAULT)
+		{
+			touched |= Bitboard::SquareMask(move.SecondaryStart());
+		}
+
+		if (move.SecondaryTarget() != DEFAULT)
+		{
+			touched |= Bitboard::SquareMask(move.SecondaryTarget());
+		}
+
+		return touched;
 	}
 
-	bool State::IsKingThreatened(int8 colour) const
+	uint64 State::PieceAttacks(int8 square) const
 	{
-		int8 king = FindPiece(colour | Piece::King)[0];
-		return IsSquareThreatened(king, colour);
+		int8 piece = Squares[square];
+		switch (Utils::GetType(piece))
+		{
+		case Piece::Knight: return Attacks::Knight(square);
+		case Piece::Bishop: return Attacks::Bishop(square, Occupancy);
+		case Piece::Rook: return Attacks::Rook(square, Occupancy);
+		case Piece::Queen: return Attacks::Queen(square, Occupancy);
+		case Piece::King: return Attacks::King(square);
+		default: return Bitboard::Empty;
+		}
 	}
 
-	std::vector<int8> State::FindPiece(int8 piece) const
+	uint64 State::RefreshAttacks(uint64 touchedSquares, UndoRecord* undo /*= nullptr*/)
 	{
-		//TODO: Cache locations of pieces so we can just look them up
-		std::vector<int8> pieceLocations;
-		for (int idx = 0; idx < 64; idx++)
+		//Whatever now stands on a touched square needs its attacks redone, and so does any slider that could see one of them.
+		//A slider's attacks can only change if an occupancy change happens on a square it currently attacks
+		uint64 stale = touchedSquares & Occupancy & ~PieceBitboards[Piece::Pawn];
+		uint64 sliders = (PieceBitboards[Piece::Bishop] | PieceBitboards[Piece::Rook] | PieceBitboards[Piece::Queen]) & Occupancy & ~touchedSquares;
+		while (sliders != Bitboard::Empty)
 		{
-			if (Squares[idx] == piece)
+			int8 square = Bitboard::PopLSB(sliders);
+			if ((AttacksFrom[square] & touchedSquares) != Bitboard::Empty)
 			{
-				pieceLocations.push_back(idx);
+				stale |= Bitboard::SquareMask(square);
+			}
+		}
 
-				if ((Utils::IsType(piece, Piece::King) || Utils::IsType(piece, Piece::Queen)) || //There can be only one
-					(pieceLocations.size() == 2 && (Utils::IsType(piece, Piece::Rook) || Utils::IsType(piece, Piece::Knight) || Utils::IsType(piece, Piece::Bishop))) ||
-					(pieceLocations.size() == 8 && Utils::IsType(piece, Piece::Pawn)))
+		uint64 vacated = touchedSquares & ~stale;
+		stale |= vacated;
+		uint64 refreshed = stale;
+		while (stale != Bitboard::Empty)
+		{
+			int8 square = Bitboard::PopLSB(stale);
+			if (undo != nullptr)
+			{
+				if (undo->SavedAttackCount < UndoRecord::MaxSavedAttacks)
 				{
-					break;
+					undo->SavedAttackSquares[undo->SavedAttackCount] = square;
+					undo->SavedAttacks[undo->SavedAttackCount] = AttacksFrom[square];
 				}
+
+				undo->SavedAttackCount = std::min<int8>(undo->SavedAttackCount + 1, UndoRecord::MaxSavedAttacks + 1);
 			}
+
+			AttacksFrom[square] = Bitboard::Contains(vacated, square) ? Bitboard::Empty : PieceAttacks(square);
 		}
 
-		return pieceLocations;
+		return refreshed;
 	}
 
-	bool State::DoesMoveExposeKing(const Move& move) const
+	void State::CombineAttacks(int8 colourIdx)
 	{
-		State afterMove(*this);
-		int8 colour = ColourToMove;
-		int8 king = FindPiece(Piece::King | move.Colour)[0];
+		uint64 attacks = Attacks::PawnSet(colourIdx, PieceBitboards[Piece::Pawn] & ColourBitboards[colourIdx]);
+		uint64 pieces = ColourBitboards[colourIdx] & ~PieceBitboards[Piece::Pawn];
+		while (pieces != Bitboard::Empty)
+		{
+			attacks |= AttacksFrom[Bitboard::PopLSB(pieces)];
+		}
 
-		afterMove.Update(move);
-		afterMove.UpdateThreatMaps();
+		ThreatMap& threats = colourIdx == 0 ? WhiteThreatMap : BlackThreatMap;
+		threats.SetMap(static_cast<int64>(attacks));
+	}
+
+	void State::RevokeCastling(int8 square)
+	{
+		switch (square)
+		{
+		case 0: WhiteCastleAvailable &= ~Castling::Queenside; break;
+		case 4: WhiteCastleAvailable = Castling::None; break;
+		case 7: WhiteCastleAvailable &= ~Castling::Kingside; break;
+		case 56: BlackCastleAvailable &= ~Castling::Queenside; break;
+		case 60: BlackCastleAvailable = Castling::None; break;
+		case 63: BlackCastleAvailable &= ~Castling::Kingside; break;
+		default: break;
+		}
+	}
+
+	void State::PutPiece(int8 square, int8 piece)
+	{
+		uint64 mask = Bitboard::SquareMask(square);
+		Squares[square] = piece;
+		PieceBitboards[Utils::GetType(piece)] |= mask;
+		ColourBitboards[Utils::ColourIndex(piece)] |= mask;
+		Occupancy |= mask;
+		Key ^= PieceKey(piece, square);
+		PawnKey ^= IsPawnKeyPiece(piece) ? PieceKey(piece, square) : 0;
+		PieceSquareScore += PieceSquare::PieceScore(piece, square);
+		Phase += PieceSquare::PiecePhase(piece);
+
+		//Kings are only ever moved, never removed for good, so the old square doesn't need clearing
+		if (Utils::IsType(piece, Piece::King))
+		{
+			KingSquares[Utils::ColourIndex(piece)] = square;
+		}
+	}
+
+	void State::RemovePiece(int8 square)
+	{
+		int8 piece = Squares[square];
+		if (piece == Piece::None)
+		{
+			return;
+		}
+
+		uint64 mask = ~Bitboard::SquareMask(square);
+		Squares[square] = Piece::None;
+		PieceBitboards[Utils::GetType(piece)] &= mask;
+		ColourBitboards[Utils::ColourIndex(piece)] &= mask;
+		Occupancy &= mask;
+		Key ^= PieceKey(piece, square);
+		PawnKey ^= IsPawnKeyPiece(piece) ? PieceKey(piece, square) : 0;
+		PieceSquareScore -= PieceSquare::PieceScore(piece, square);
+		Phase -= PieceSquare::PiecePhase(piece);
+	}
 
-		int8 kingSquare = Utils::IsType(Squares[move.StartSquare], Piece::King) ? move.TargetSquare : king;
-		return afterMove.IsSquareThreatened(kingSquare, colour);
+	void State::UpdateThreatMaps()
+	{
+		for (int8 square = 0; square < 64; square++)
+		{
+			AttacksFrom[square] = PieceAttacks(square);
+		}
+
+		CombineAttacks(0);
+		CombineAttacks(1);
+	}
+
+	uint64 State::ComputeKey() const
+	{
+		uint64 key = CastlingKey(WhiteCastleAvailable, BlackCastleAvailable) ^ EnPassentKey(EnPassentTarget);
+		if (ColourToMove == Piece::Black)
+		{
+			key ^= ZobristKeys.BlackToMove;
+		}
+
+		uint64 pieces = Occupancy;
+		while (pieces != Bitboard::Empty)
+		{
+			int8 square = Bitboard::PopLSB(pieces);
+			key ^= PieceKey(Squares[square], square);
+		}
+
+		return key;
+	}
+
+	uint64 State::ComputePawnKey() const
+	{
+		uint64 key = 0;
+		uint64 pieces = PieceBitboards[Piece::Pawn] | PieceBitboards[Piece::King];
+		while (pieces != Bitboard::Empty)
+		{
+			int8 square = Bitboard::PopLSB(pieces);
+			key ^= PieceKey(Squares[square], square);
+		}
+
+		return key;
+	}
+
+	PieceSquare::Score State::ComputePieceSquareScore() const
+	{
+		PieceSquare::Score score = 0;
+		uint64 pieces = Occupancy;
+		while (pieces != Bitboard::Empty)
+		{
+			int8 square = Bitboard::PopLSB(pieces);
+			score += PieceSquare::PieceScore(Squares[square], square);
+		}
+
+		return score;
+	}
+
+	int16 State::ComputePhase() const
+	{
+		int16 phase = 0;
+		for (int8 type = Piece::Knight; type <= Piece::Queen; type++)
+		{
+			phase += static_cast<int16>(Bitboard::PopCount(PieceBitboards[type]) * PieceSquare::PhaseWeights[type]);
+		}
+
+		return phase;
+	}
+
+	bool State::IsSquareThreatened(int8 square, int8 friendlyColour) const
+	{
+		const ThreatMap& threats = Utils::IsColour(friendlyColour, Constants::Piece::White) ? BlackThreatMap : WhiteThreatMap;
+		return threats.IsThreatened(square);
+	}
+
+	bool State::IsKingThreatened(int8 colour) const
+	{
+		return IsSquareThreatened(KingSquare(colour), colour);
 	}
 }
\ No newline at end of file
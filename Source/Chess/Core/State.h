@@ -2,14 +2,37 @@
 
 #include "CoreMinimal.h"
 #include <string>
-#include <vector>
 
+#include "Bitboard.h"
 #include "Constants.h"
 #include "Move.h"
+#include "PieceSquareTables.h"
 #include "ThreatMap.h"
+#include "Utils.h"
 
 namespace Chess
 {
+	//Everything needed to take a move back that can't be worked out from the move itself
+	struct UndoRecord
+	{
+		Move MoveMade;
+		int8 CapturedPiece;
+		int8 WhiteCastleAvailable;
+		int8 BlackCastleAvailable;
+		int8 EnPassentTarget;
+		int16 HalfMoveClock;
+		uint64 Key;
+
+		int64 WhiteThreats;
+		int64 BlackThreats;
+
+		//The per-piece attacks the move overwrote. If more than fit were disturbed Revert works them all out again instead
+		static const int8 MaxSavedAttacks = 12;
+		int8 SavedAttackCount;
+		int8 SavedAttackSquares[MaxSavedAttacks];
+		uint64 SavedAttacks[MaxSavedAttacks];
+	};
+
 	struct State
 	{
 	public:
@@ -19,25 +42,92 @@ namespace Chess
 		int8 BlackCastleAvailable;
 		int8 EnPassentTarget;
 
+		//Plies since the last capture or pawn move, and the move number as it appears in FEN
+		int16 HalfMoveClock;
+		int16 FullMoveNumber;
+
+		//Bitboard view of Squares, indexed by piece type (Piece::None is unused) and colour index
+		uint64 PieceBitboards[7];
+		uint64 ColourBitboards[2];
+		uint64 Occupancy;
+
+		//Where each colour's king is, indexed by colour index. Kept up to date by PutPiece so it never needs searching for
+		int8 KingSquares[2];
+
+		//Zobrist key of the position, kept up to date by every edit to the board so it's never worked out from scratch
+		uint64 Key;
+
+		//Key of just the pawns and kings, for looking up pawn structure evaluations. The kings are in it because how well
+		//the pawns shelter them is part of that evaluation
+		uint64 PawnKey;
+
+		//Material and piece-square score from white's point of view, and how far from the endgame the material left puts
+		//the game. Kept up to date the same way as Key, so evaluating a position never has to look at the board
+		PieceSquare::Score PieceSquareScore;
+		int16 Phase;
+
 		ThreatMap WhiteThreatMap;
 		ThreatMap BlackThreatMap;
 
+		//Squares attacked by the piece on each square. Empty squares and pawns attack nothing here, pawn attacks don't depend on the
+		//rest of the board so the threat maps add them in a whole set at a time when combining these by colour
+		uint64 AttacksFrom[64];
+
+		//The FEN isn't checked, anything that hasn't come from a trusted source should go through IsValidFEN first
 		State(const std::string& fen);
 		State() :
 			ColourToMove(Constants::Piece::White), WhiteCastleAvailable(Constants::Castling::Both), BlackCastleAvailable(Constants::Castling::Both),
-			EnPassentTarget(Constants::NO_EN_PASSENT), WhiteThreatMap(*this, Constants::Piece::White), BlackThreatMap(*this, Constants::Piece::Black)
+			EnPassentTarget(Constants::NO_EN_PASSENT), HalfMoveClock(0), FullMoveNumber(1),
+			Occupancy(Bitboard::Empty), KingSquares{ Constants::DEFAULT, Constants::DEFAULT }, Key(0), PawnKey(0), PieceSquareScore(0), Phase(0), WhiteThreatMap(Constants::Piece::White), BlackThreatMap(Constants::Piece::Black)
 		{
 			memset(Squares, 0, 64);
+			memset(PieceBitboards, 0, sizeof(PieceBitboards));
+			memset(ColourBitboards, 0, sizeof(ColourBitboards));
+			memset(AttacksFrom, 0, sizeof(AttacksFrom));
+			Key = ComputeKey();
 		}
 
-		void Update(const Move& move);
+		//Applies the move and returns what's needed to take it back again with Revert
+		UndoRecord Update(const Move& move);
+		void Revert(const UndoRecord& undo);
+
+		//False, with the reason in error, for a FEN the constructor can't set up a playable position from: a rank that isn't
+		//eight squares, an unknown piece, a side without exactly one king, a pawn on the first or last rank, a malformed field
+		//or the side not to move already in check
+		static bool IsValidFEN(const std::string& fen, std::string& error);
+
+		//Rebuilds every piece's attacks and the threat maps from scratch, Update and Revert only redo what a move disturbs
 		void UpdateThreatMaps();
 
+		//The key worked out from scratch, only needed when setting up a position or checking Key is right
+		uint64 ComputeKey() const;
+
+		//Likewise for PawnKey, PieceSquareScore and Phase
+		uint64 ComputePawnKey() const;
+		PieceSquare::Score ComputePieceSquareScore() const;
+		int16 ComputePhase() const;
+
 		bool IsSquareThreatened(int8 square, int8 friendlyColour) const;
 		bool IsKingThreatened(int8 colour) const;
-		bool DoesMoveExposeKing(const Move& move) const;
 
-		std::vector<int8> FindPiece(int8 piece) const;
+		inline int8 KingSquare(int8 colour) const { return KingSquares[Utils::ColourIndex(colour)]; }
+
+		//Every square holding the piece, walk the set with Bitboard::PopLSB
+		inline uint64 FindPiece(int8 piece) const { return GetPieces(piece, Utils::GetType(piece)); }
+
+		inline uint64 GetPieces(int8 colour) const { return ColourBitboards[Utils::ColourIndex(colour)]; }
+		inline uint64 GetPieces(int8 colour, int8 type) const { return PieceBitboards[type] & ColourBitboards[Utils::ColourIndex(colour)]; }
+
+	private:
+		//Keep the mailbox and the bitboards in step, all board edits should go through these
+		void PutPiece(int8 square, int8 piece);
+		void RemovePiece(int8 square);
+		void RevokeCastling(int8 square);
 
+		static uint64 TouchedSquares(const Move& move);
+		uint64 PieceAttacks(int8 square) const;
+		//Returns the squares whose attacks were redone
+		uint64 RefreshAttacks(uint64 touchedSquares, UndoRecord* undo = nullptr);
+		void CombineAttacks(int8 colourIdx);
 	};
 }
\ No newline at end of file
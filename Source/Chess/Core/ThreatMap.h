@@ -19,9 +19,8 @@ namespace Chess
 
 		void CalculateMap(const State& board);
 		inline bool IsThreatened(int8 square) const { return (Map & (1ULL << square)); }
-
-	private:
-		inline void SetThreatened(int8 square) { Map |= 1ULL << square; }
+		inline int64 GetMap() const { return Map; }
+		inline void SetMap(int64 map) { Map = map; }
 
 	private:
 		int8 Colour;
@@ -0,0 +1,215 @@
+#include "TranspositionTable.h"
+
+#include <limits>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace Chess
+{
+	namespace
+	{
+		//Large tables are aligned to a huge page so the kernel can back them with 2MB pages, cutting TLB misses on every probe
+		const size_t HugePageSize = 2 * 1024 * 1024;
+
+		void* AllocateTable(size_t bytes, bool hugePages)
+		{
+#if defined(_MSC_VER)
+			return _aligned_malloc(bytes, 64);
+#else
+			size_t alignment = hugePages && bytes >= HugePageSize ? HugePageSize : 64;
+			bytes = (bytes + alignment - 1) / alignment * alignment;
+
+			void* memory = aligned_alloc(alignment, bytes);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+			if (memory != nullptr && alignment == HugePageSize)
+			{
+				madvise(memory, bytes, MADV_HUGEPAGE);
+			}
+#endif
+			return memory;
+#endif
+		}
+
+		void FreeTable(void* memory)
+		{
+#if defined(_MSC_VER)
+			_aligned_free(memory);
+#else
+			free(memory);
+#endif
+		}
+
+		//Data layout, low bits first: 16 bits move, 16 bits score, 8 bits depth, 2 bits bound, 6 bits generation
+		inline uint16 UnpackMove(uint64 data) { return static_cast<uint16>(data); }
+		inline int16 UnpackScore(uint64 data) { return static_cast<int16>(data >> 16); }
+		inline int8 UnpackDepth(uint64 data) { return static_cast<int8>(data >> 32); }
+		inline uint8 UnpackBound(uint64 data) { return static_cast<uint8>((data >> 40) & 0x3); }
+		inline uint8 UnpackGeneration(uint64 data) { return static_cast<uint8>(data >> 42) & 0x3F; }
+	}
+
+	TranspositionTable::TranspositionTable(int32 sizeMB, bool hugePages /*= true*/) :
+		Buckets(nullptr), BucketCount(0), BucketMask(0), SizeMB(0), HugePages(hugePages), Generation(0)
+	{
+		Resize(sizeMB);
+	}
+
+	TranspositionTable::~TranspositionTable()
+	{
+		FreeTable(Buckets);
+	}
+
+	bool TranspositionTable::Resize(int32 sizeMB)
+	{
+		//Round down to a power of two so the bucket index is just the low bits of the key
+		uint64 buckets = (static_cast<uint64>(std::max(sizeMB, 1)) << 20) / sizeof(Bucket);
+		uint64 bucketCount = 1;
+		while (bucketCount * 2 <= buckets)
+		{
+			bucketCount *= 2;
+		}
+
+		//Halve until the memory is there, down to a megabyte
+		const uint64 MinimumBuckets = (static_cast<uint64>(1) << 20) / sizeof(Bucket);
+		Bucket* allocated = static_cast<Bucket*>(AllocateTable(bucketCount * sizeof(Bucket), HugePages));
+		bool fullSize = allocated != nullptr;
+		while (allocated == nullptr && bucketCount > MinimumBuckets)
+		{
+			bucketCount /= 2;
+			allocated = static_cast<Bucket*>(AllocateTable(bucketCount * sizeof(Bucket), HugePages));
+		}
+
+		if (allocated != nullptr)
+		{
+			FreeTable(Buckets);
+			Buckets = new (allocated) Bucket[bucketCount];
+			BucketCount = bucketCount;
+			BucketMask = bucketCount - 1;
+			SizeMB = static_cast<int32>((bucketCount * sizeof(Bucket)) >> 20);
+		}
+
+		Clear();
+		return fullSize;
+	}
+
+	void TranspositionTable::Clear()
+	{
+		Generation.store(0, std::memory_order_relaxed);
+		if (!IsValid())
+		{
+			return;
+		}
+
+		//An all zero slot recovers key 0 with no bound, which never counts as a hit
+		memset(static_cast<void*>(Buckets), 0, BucketCount * sizeof(Bucket));
+	}
+
+	uint64 TranspositionTable::Pack(int32 depth, uint8 bound, int32 score, const Move& bestMove, uint8 generation)
+	{
+		return static_cast<uint64>(bestMove.GetData()) |
+			(static_cast<uint64>(static_cast<uint16>(score)) << 16) |
+			(static_cast<uint64>(static_cast<uint8>(depth)) << 32) |
+			(static_cast<uint64>(bound & 0x3) << 40) |
+			(static_cast<uint64>(generation & GenerationMask) << 42);
+	}
+
+	bool TranspositionTable::Probe(uint64 key, TableEntry& entry) const
+	{
+		if (!IsValid())
+		{
+			return false;
+		}
+
+		const Bucket& bucket = BucketFor(key);
+		for (const Slot& slot : bucket.Slots)
+		{
+			uint64 data = slot.Data.load(std::memory_order_relaxed);
+			uint64 check = slot.Check.load(std::memory_order_relaxed);
+			if ((check ^ data) != key || UnpackBound(data) == Bound::None)
+			{
+				continue;
+			}
+
+			entry.BestMove = Move::FromData(UnpackMove(data));
+			entry.Score = UnpackScore(data);
+			entry.Depth = UnpackDepth(data);
+			entry.Bound = UnpackBound(data);
+			return true;
+		}
+
+		return false;
+	}
+
+	void TranspositionTable::Store(uint64 key, int32 depth, uint8 bound, int32 score, const Move& bestMove)
+	{
+		if (!IsValid())
+		{
+			return;
+		}
+
+		Bucket& bucket = BucketFor(key);
+		uint8 generation = GetGeneration();
+
+		//Overwrite this position's own entry if it has one, otherwise the shallowest, with entries from older searches counting as shallower
+		Slot* replace = &bucket.Slots[0];
+		int32 replaceWorth = std::numeric_limits<int32>::max();
+		uint64 oldData = 0;
+		bool samePosition = false;
+		for (Slot& slot : bucket.Slots)
+		{
+			uint64 data = slot.Data.load(std::memory_order_relaxed);
+			if ((slot.Check.load(std::memory_order_relaxed) ^ data) == key)
+			{
+				replace = &slot;
+				oldData = data;
+				samePosition = true;
+				break;
+			}
+
+			int32 age = (generation - UnpackGeneration(data)) & GenerationMask;
+			int32 worth = UnpackBound(data) == Bound::None ? std::numeric_limits<int32>::min() : UnpackDepth(data) - 8 * age;
+			if (worth < replaceWorth)
+			{
+				replace = &slot;
+				oldData = data;
+				replaceWorth = worth;
+			}
+		}
+
+		//Keep a known best move rather than lose it to a search of the same position that didn't find one
+		Move move = bestMove;
+		if (move.IsNull() && samePosition)
+		{
+			move = Move::FromData(UnpackMove(oldData));
+		}
+
+		uint64 data = Pack(depth, bound, score, move, generation);
+		replace->Data.store(data, std::memory_order_relaxed);
+		replace->Check.store(key ^ data, std::memory_order_relaxed);
+	}
+
+	int32 TranspositionTable::HashFull() const
+	{
+		if (!IsValid())
+		{
+			return 0;
+		}
+
+		const uint64 SampleBuckets = std::min<uint64>(250, BucketCount);
+
+		uint8 generation = GetGeneration();
+		int32 used = 0;
+		for (uint64 idx = 0; idx < SampleBuckets; idx++)
+		{
+			for (const Slot& slot : Buckets[idx].Slots)
+			{
+				uint64 data = slot.Data.load(std::memory_order_relaxed);
+				used += UnpackBound(data) != Bound::None && UnpackGeneration(data) == generation ? 1 : 0;
+			}
+		}
+
+		return static_cast<int32>(used * 1000 / (SampleBuckets * BucketSize));
+	}
+}
\ No newline at end of file
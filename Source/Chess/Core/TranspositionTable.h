@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+#include "Move.h"
+
+namespace Chess
+{
+	namespace Bound
+	{
+		const uint8 None = 0;
+
+		//The score is at most this, every move failed low
+		const uint8 Upper = 1;
+
+		//The score is at least this, a move failed high
+		const uint8 Lower = 2;
+		const uint8 Exact = Upper | Lower;
+	}
+
+	struct TableEntry
+	{
+		Move BestMove;
+		int16 Score;
+		int8 Depth;
+		uint8 Bound;
+	};
+
+	/*
+		Position cache shared by every search thread without locks. Entries are two 64-bit words, the packed data and the key
+		XORed with it. A reader only believes an entry if the key it recovers matches, so an entry torn by two threads writing
+		at once just reads as a miss. Entries are grouped into buckets the size of a cache line, so a probe costs one miss.
+	*/
+	class TranspositionTable
+	{
+	public:
+		//With hugePages, tables of 2MB or more ask the OS to back them with huge pages where it can (Linux only), which cuts
+		//TLB misses on every probe. Off leaves the allocation to the ordinary allocator. If there isn't even a megabyte free
+		//the table is left empty, see IsValid
+		explicit TranspositionTable(int32 sizeMB, bool hugePages = true);
+		~TranspositionTable();
+
+		TranspositionTable(const TranspositionTable&) = delete;
+		TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+		//Replaces the table with a new, empty one. If there isn't the memory for the size asked for, smaller sizes are tried
+		//in turn and false is returned, GetSizeMB says what was got. If none can be had the old table is kept, cleared, or the
+		//table stays empty if there wasn't one. Not safe while anything is searching
+		bool Resize(int32 sizeMB);
+		void Clear();
+
+		//Call at the start of each search, entries from older searches are the first to be replaced. Safe while other threads
+		//search, the worst that happens is a few of their entries being aged a search early
+		inline void NewSearch() { Generation.store((GetGeneration() + 1) & GenerationMask, std::memory_order_relaxed); }
+
+		//An empty table never hits and stores nothing, a search with one still works, it just has nothing to remember with
+		bool Probe(uint64 key, TableEntry& entry) const;
+		void Store(uint64 key, int32 depth, uint8 bound, int32 score, const Move& bestMove);
+
+		//Permille of the table used by the current search, from a sample at the start of the table
+		int32 HashFull() const;
+
+		//False if there wasn't the memory for any table at all
+		inline bool IsValid() const { return Buckets != nullptr; }
+
+		//0 for an empty table
+		inline int32 GetSizeMB() const { return SizeMB; }
+
+	private:
+		static const int32 BucketSize = 4;
+		static const uint8 GenerationMask = 0x3F;
+
+		struct Slot
+		{
+			std::atomic<uint64> Check;
+			std::atomic<uint64> Data;
+		};
+
+		struct alignas(64) Bucket
+		{
+			Slot Slots[BucketSize];
+		};
+
+		static uint64 Pack(int32 depth, uint8 bound, int32 score, const Move& bestMove, uint8 generation);
+
+		inline Bucket& BucketFor(uint64 key) const { return Buckets[key & BucketMask]; }
+		inline uint8 GetGeneration() const { return Generation.load(std::memory_order_relaxed); }
+
+		Bucket* Buckets;
+		uint64 BucketCount;
+		uint64 BucketMask;
+		int32 SizeMB;
+		bool HugePages;
+		std::atomic<uint8> Generation;
+	};
+}
\ No newline at end of file
@@ -12,6 +12,8 @@ namespace Chess
 		inline int8 GetColour(int8 piece) { return piece & ~Constants::Piece::ClassMask; }
 		inline bool IsColour(int8 piece, int8 colour) { return (piece & colour) == colour; }
 		inline bool IsType(int8 piece, int8 type) { return (piece & Constants::Piece::ClassMask) == type; }
+		inline int8 ColourIndex(int8 colour) { return IsColour(colour, Constants::Piece::Black) ? 1 : 0; }
+		inline int8 GetType(int8 piece) { return piece & Constants::Piece::ClassMask; }
 		inline bool IsSlidingPiece(int8 piece) { return IsType(piece, Constants::Piece::Bishop) || IsType(piece, Constants::Piece::Rook) || IsType(piece, Constants::Piece::Queen); }
 
 		inline int8 RankIndex(int8 square) { return square >> 3; }
@@ -21,8 +23,8 @@ namespace Chess
 		std::string PieceName(int8 piece);
 		std::string AlgebraicName(int8 piece);
 
-		static std::string RankNames = "12345678";
-		static std::string FileNames = "abcdefgh";
+		const char RankNames[] = "12345678";
+		const char FileNames[] = "abcdefgh";
 
 		inline std::string SquareName(int8 square)
 		{
@@ -34,9 +36,26 @@ namespace Chess
 
 		inline int8 SquareFromName(const char* name)
 		{
-			size_t file = FileNames.find(name[0]);
-			size_t rank = RankNames.find(name[1]);
-			return IndexFromCoord(rank, file);
+			return IndexFromCoord(name[1] - RankNames[0], name[0] - FileNames[0]);
 		}
+
+		//xorshift64*, seeded so anything built from it (magics, hash keys) comes out the same every run
+		struct Random
+		{
+			uint64 Seed;
+
+			explicit Random(uint64 seed) : Seed(seed) {}
+
+			uint64 Next()
+			{
+				Seed ^= Seed >> 12;
+				Seed ^= Seed << 25;
+				Seed ^= Seed >> 27;
+				return Seed * 2685821657736338717ULL;
+			}
+
+			//Numbers with few bits set, magics like these are found much faster
+			uint64 Sparse() { return Next() & Next() & Next(); }
+		};
 	}
 }
\ No newline at end of file
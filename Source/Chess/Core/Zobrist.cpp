@@ -0,0 +1,38 @@
+#include "Zobrist.h"
+
+namespace Chess
+{
+	namespace Zobrist
+	{
+		const Keys ZobristKeys;
+
+		Keys::Keys()
+		{
+			Utils::Random random(0x9E3779B97F4A7C15ULL);
+
+			for (int8 colourIdx = 0; colourIdx < 2; colourIdx++)
+			{
+				for (int8 type = 0; type < 7; type++)
+				{
+					for (int8 square = 0; square < 64; square++)
+					{
+						Pieces[colourIdx][type][square] = random.Next();
+					}
+				}
+			}
+
+			BlackToMove = random.Next();
+
+			//Every combination gets its own key rather than XORing one per right, so changing rights is always a single XOR pair
+			for (int8 rights = 0; rights < 16; rights++)
+			{
+				Castling[rights] = random.Next();
+			}
+
+			for (int8 file = 0; file < 8; file++)
+			{
+				EnPassentFile[file] = random.Next();
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Constants.h"
+#include "Utils.h"
+
+namespace Chess
+{
+	namespace Zobrist
+	{
+		/*
+			Random numbers XORed together to give each position a 64-bit key: one per piece on each square, one for
+			the side to move, one per combination of castling rights and one per en passent file. There is a single
+			instance, built during static initialisation and only read afterwards.
+		*/
+		struct Keys
+		{
+		public:
+			Keys();
+
+			//Indexed by colour index, piece type and square
+			uint64 Pieces[2][7][64];
+			uint64 BlackToMove;
+
+			//Indexed by white's castling rights in the low two bits and black's in the next two
+			uint64 Castling[16];
+			uint64 EnPassentFile[8];
+		};
+
+		extern const Keys ZobristKeys;
+
+		inline uint64 PieceKey(int8 piece, int8 square)
+		{
+			return ZobristKeys.Pieces[Utils::ColourIndex(piece)][Utils::GetType(piece)][square];
+		}
+
+		//Pieces that go into the pawn key as well as the full one
+		inline bool IsPawnKeyPiece(int8 piece)
+		{
+			return Utils::IsType(piece, Constants::Piece::Pawn) || Utils::IsType(piece, Constants::Piece::King);
+		}
+
+		inline uint64 CastlingKey(int8 whiteCastle, int8 blackCastle)
+		{
+			return ZobristKeys.Castling[whiteCastle | (blackCastle << 2)];
+		}
+
+		//Nothing when there's no en passent square, so positions only differ by one if a pawn has just moved two squares
+		inline uint64 EnPassentKey(int8 enPassentTarget)
+		{
+			return enPassentTarget == Constants::NO_EN_PASSENT ? 0 : ZobristKeys.EnPassentFile[Utils::FileIndex(enPassentTarget)];
+		}
+	}
+}
\ No newline at end of file
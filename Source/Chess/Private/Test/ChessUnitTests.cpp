@@ -3,54 +3,554 @@
 #include "Test/ChessUnitTests.h"
 
 #include "../../Core/Board.h"
+#include "../../Core/EngineWorker.h"
+#include "../../Core/Evaluation.h"
 #include "../../Core/MoveGeneration.h"
+#include "../../Core/MovePicker.h"
+#include "../../Core/Nnue.h"
+#include "../../Core/Perft.h"
+#include "../../Core/Search.h"
 
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include <atomic>
 #include <chrono>
+#include <limits>
+#include <sstream>
 using namespace std::chrono;
 using namespace Chess;
 
 DEFINE_LOG_CATEGORY_STATIC(LogChessTest, Log, All);
 
-int MoveGenerationTest(Board& board, int depth)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessUnitTests, "ChessTest.DepthTest.Shannon Number", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool ChessUnitTests::RunTest(const FString& Parameters)
 {
-	if (depth == 0)
+	static const int64 ShannonNumber[] = { 20, 400, 8902, 197281, 4865609, 119060324, 3195901860, 84998978956, 2439530234167, 69352859712417 };
+	static const int MaxDepth = 5;
+
+	//Big enough that depth 5 from the start position never has to overwrite anything worth keeping
+	static const int32 PerftCacheMB = 64;
+	const int32 Threads = FMath::Max<int32>(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1);
+
+	Board board;
+	PerftCache cache(PerftCacheMB);
+	for (int depth = 0; depth < MaxDepth; depth++)
 	{
-		return 1;
+		auto start = high_resolution_clock::now();
+		int64 permutations = Perft::Count(board, depth + 1);
+		auto stop = high_resolution_clock::now();
+		int64 rawMs = duration_cast<milliseconds>(stop - start).count();
+
+		UE_LOG(LogChessTest, Display, TEXT("Found %lld moves at depth %d in %lld ms"), permutations, depth, rawMs);
+		if (permutations != ShannonNumber[depth])
+		{
+			UE_LOG(LogChessTest, Error, TEXT("Expected %lld moves!"), ShannonNumber[depth]);
+			return false;
+		}
+
+		//Same count again with transpositions looked up rather than walked, starting cold each time so the speedup is honest
+		cache.Clear();
+		start = high_resolution_clock::now();
+		int64 hashedPermutations = Perft::Count(board, depth + 1, cache);
+		stop = high_resolution_clock::now();
+		int64 hashedMs = duration_cast<milliseconds>(stop - start).count();
+
+		UE_LOG(LogChessTest, Display, TEXT("Hashed: %lld moves in %lld ms, %.1f%% hits, %.1fx speedup"), hashedPermutations, hashedMs,
+			cache.GetHitRate() * 100.0, static_cast<double>(rawMs) / FMath::Max<int64>(hashedMs, 1));
+		if (hashedPermutations != permutations)
+		{
+			UE_LOG(LogChessTest, Error, TEXT("Hashed perft disagrees with the raw count!"));
+			return false;
+		}
+
+		Perft::ParallelResult parallel = Perft::ParallelCount(board, depth + 1, Threads);
+		UE_LOG(LogChessTest, Display, TEXT("Parallel: %lld moves in %lld ms on %d threads"), parallel.Nodes, static_cast<int64>(parallel.Seconds * 1000.0), Threads);
+		for (int32 worker = 0; worker < Threads; worker++)
+		{
+			const Perft::WorkerStats& stats = parallel.Workers[worker];
+			UE_LOG(LogChessTest, Display, TEXT("    Thread %d: %lld nodes, %d subtrees (%d stolen), %.0f nodes/sec"), worker, stats.Nodes, stats.Subtrees, stats.Stolen, stats.NodesPerSecond());
+		}
+
+		if (parallel.Nodes != permutations)
+		{
+			UE_LOG(LogChessTest, Error, TEXT("Parallel perft disagrees with the raw count!"));
+			return false;
+		}
+
+		//Every thread reading and writing the one cache at once
+		cache.Clear();
+		Perft::ParallelResult hashedParallel = Perft::ParallelCount(board, depth + 1, Threads, cache);
+		UE_LOG(LogChessTest, Display, TEXT("Hashed parallel: %lld moves in %lld ms on %d threads, %.1f%% hits"), hashedParallel.Nodes,
+			static_cast<int64>(hashedParallel.Seconds * 1000.0), Threads, cache.GetHitRate() * 100.0);
+		if (hashedParallel.Nodes != permutations)
+		{
+			UE_LOG(LogChessTest, Error, TEXT("Hashed parallel perft disagrees with the raw count!"));
+			return false;
+		}
 	}
 
-	std::vector<Chess::Move> movesThisPly = MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove());
-	int numPositions = 0;
-	for (Chess::Move& move : movesThisPly)
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessPerftSuiteTests, "ChessTest.DepthTest.Perft Suite", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool ChessPerftSuiteTests::RunTest(const FString& Parameters)
+{
+	//Depths expected to count more leaves than this are left to the standalone chess-perft runs
+	static const int64 MaxNodes = 20000000;
+
+	//Far enough below a development build to only trip on a real throughput regression
+	static const double MinNodesPerSecond = 2000000.0;
+
+	TArray<FString> lines;
+	FString suitePath = FPaths::Combine(FPaths::GameSourceDir(), TEXT("Chess/Private/Test/PerftSuite.epd"));
+	if (!FFileHelper::LoadFileToStringArray(lines, *suitePath))
 	{
-		board.MakeMove(move);
-		numPositions += MoveGenerationTest(board, depth - 1);
-		board.UnmakeMove();
+		UE_LOG(LogChessTest, Error, TEXT("Couldn't load %s"), *suitePath);
+		return false;
 	}
 
-	return numPositions;
+	bool passed = true;
+	int64 totalNodes = 0;
+	double totalSeconds = 0.0;
+
+	Perft::SuitePosition position;
+	for (const FString& line : lines)
+	{
+		if (!Perft::ParseSuiteLine(TCHAR_TO_UTF8(*line), position))
+		{
+			continue;
+		}
+
+		Board board(position.Fen);
+		for (const std::pair<int32, int64>& expected : position.Expected)
+		{
+			if (expected.second > MaxNodes)
+			{
+				continue;
+			}
+
+			auto start = high_resolution_clock::now();
+			int64 permutations = Perft::Count(board, expected.first);
+			double seconds = duration<double>(high_resolution_clock::now() - start).count();
+			totalNodes += permutations;
+			totalSeconds += seconds;
+
+			if (permutations != expected.second)
+			{
+				UE_LOG(LogChessTest, Error, TEXT("%s at depth %d: found %lld moves, expected %lld"), UTF8_TO_TCHAR(position.Fen.c_str()), expected.first, permutations, expected.second);
+				for (const std::pair<Chess::Move, int64>& subtree : Perft::Divide(board, expected.first))
+				{
+					UE_LOG(LogChessTest, Display, TEXT("    %s: %lld"), UTF8_TO_TCHAR(subtree.first.ToString().c_str()), subtree.second);
+				}
+
+				passed = false;
+			}
+		}
+	}
+
+	double nodesPerSecond = totalSeconds > 0.0 ? totalNodes / totalSeconds : 0.0;
+	UE_LOG(LogChessTest, Display, TEXT("Perft suite: %lld moves in %.3f s, %.0f nodes/sec"), totalNodes, totalSeconds, nodesPerSecond);
+	if (nodesPerSecond < MinNodesPerSecond)
+	{
+		UE_LOG(LogChessTest, Error, TEXT("Below the budget of %.0f nodes/sec!"), MinNodesPerSecond);
+		passed = false;
+	}
+
+	return passed;
 }
 
-IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessUnitTests, "ChessTest.DepthTest.Shannon Number", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessSearchTests, "ChessTest.Search.Finds Mate", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 
-bool ChessUnitTests::RunTest(const FString& Parameters)
+bool ChessSearchTests::RunTest(const FString& Parameters)
 {
-	static const int64 ShannonNumber[] = { 20, 400, 8902, 197281, 4865609, 4865609, 119060324, 3195901860, 84998978956, 2439530234167, 69352859712417 };
-	static const int MaxDepth = 5;
+	struct MatePosition
+	{
+		const char* Fen;
+		const char* BestMove;
+		int32 MateInPlies;
+	};
 
-	Board board;
-	for (int depth = 0; depth < MaxDepth; depth++)
+	static const MatePosition Positions[] =
+	{
+		{ "6k1/5ppp/8/8/8/8/5PPP/1R4K1 w - - 0 1", "b1b8", 1 },
+		{ "r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", "d5f6", 3 },
+	};
+
+	//Helpers sharing the table mustn't change what the main thread finds
+	static const int32 ThreadCounts[] = { 1, 4 };
+
+	bool passed = true;
+	for (const MatePosition& position : Positions)
+	{
+		for (int32 threads : ThreadCounts)
+		{
+			Board board(position.Fen);
+			TranspositionTable table(16);
+			ParallelSearcher searcher(table, threads);
+			Search::Limits limits;
+			limits.MaxDepth = 4;
+
+			Search::Result result = searcher.Run(board, limits);
+			UE_LOG(LogChessTest, Display, TEXT("%s (%d threads): %s scores %d at depth %d after %lld nodes"), UTF8_TO_TCHAR(position.Fen), threads,
+				UTF8_TO_TCHAR(result.BestMove.ToString().c_str()), result.Score, result.Depth, result.Nodes);
+
+			if (result.BestMove.ToString() != position.BestMove || result.Score != Search::Mate - position.MateInPlies)
+			{
+				UE_LOG(LogChessTest, Error, TEXT("Expected %s mating in %d plies!"), UTF8_TO_TCHAR(position.BestMove), position.MateInPlies);
+				passed = false;
+			}
+		}
+	}
+
+	return passed;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessParallelLimitTests, "ChessTest.Search.Parallel Limits", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool ChessParallelLimitTests::RunTest(const FString& Parameters)
+{
+	//Limits so tight the main thread is done before most helpers have started, every search has to come back regardless
+	static const int32 Runs = 50;
+
+	TranspositionTable table(16);
+	ParallelSearcher searcher(table, 8);
+	bool passed = true;
+	for (int32 run = 0; run < Runs; run++)
 	{
+		Board board;
+		Search::Limits limits;
+		if (run % 2 == 0)
+		{
+			limits.MaxNodes = 1024;
+		}
+		else
+		{
+			limits.MaxMilliseconds = 1;
+		}
+
 		auto start = high_resolution_clock::now();
-		int64 permutations = MoveGenerationTest(board, depth + 1);
-		auto stop = high_resolution_clock::now();
+		Search::Result result = searcher.Run(board, limits);
+		int64 elapsedMs = duration_cast<milliseconds>(high_resolution_clock::now() - start).count();
 
-		UE_LOG(LogChessTest, Display, TEXT("Found %d moves at depth %d in %d ms"), permutations, depth, duration_cast<milliseconds>(stop - start).count());
-		if (permutations != ShannonNumber[depth])
+		if (result.BestMove.IsNull() || elapsedMs > 1000)
 		{
-			UE_LOG(LogChessTest, Error, TEXT("Expected %d moves!"), ShannonNumber[depth]);
-			return false;
+			UE_LOG(LogChessTest, Error, TEXT("Run %d took %lld ms to return %s!"), run, elapsedMs, UTF8_TO_TCHAR(result.BestMove.ToString().c_str()));
+			passed = false;
+		}
+	}
+
+	return passed;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessMoveOrderingTests, "ChessTest.Search.Move Ordering", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool ChessMoveOrderingTests::RunTest(const FString& Parameters)
+{
+	static const char* Positions[] =
+	{
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	};
+
+	bool passed = true;
+	for (const char* position : Positions)
+	{
+		Board board(position);
+		const State& state = board.BoardState;
+
+		MoveList legalMoves;
+		MoveGeneration::GenerateMoves(state, state.ColourToMove, legalMoves);
+
+		//A hash move and killers that are legal here, and one killer from nowhere, none of which may be handed out twice
+		MoveOrdering::ButterflyHistory history;
+		Move hashMove = legalMoves[legalMoves.Size() - 1];
+		Move killers[MoveOrdering::KillerSlots] = { legalMoves[0], Move::CreateMove(0, 63) };
+		for (const Move& move : legalMoves)
+		{
+			if (!move.IsCapture() && !move.IsPromotion() && move != hashMove)
+			{
+				killers[0] = move;
+				history.Reward(state.ColourToMove, move, 4);
+			}
+		}
+
+		MovePicker picker(state, hashMove, killers, history);
+		MoveList picked;
+		int32 lastCaptureScore = std::numeric_limits<int32>::max();
+		Move move;
+		while (picker.Next(move))
+		{
+			if (picked.Contains(move) || !legalMoves.Contains(move))
+			{
+				UE_LOG(LogChessTest, Error, TEXT("%s: %s handed out twice, or isn't legal!"), UTF8_TO_TCHAR(position), UTF8_TO_TCHAR(move.ToString().c_str()));
+				passed = false;
+			}
+
+			//After the hash move, captures come first with the most valuable victims first
+			if (picked.Size() > 0 && (move.IsCapture() || move.IsPromotion()))
+			{
+				int32 score = MoveOrdering::CaptureScore(state, move);
+				if (score > lastCaptureScore)
+				{
+					UE_LOG(LogChessTest, Error, TEXT("%s: %s handed out after a lower scoring capture!"), UTF8_TO_TCHAR(position), UTF8_TO_TCHAR(move.ToString().c_str()));
+					passed = false;
+				}
+
+				lastCaptureScore = score;
+			}
+
+			picked.Add(move);
 		}
+
+		if (picked.Size() != legalMoves.Size())
+		{
+			UE_LOG(LogChessTest, Error, TEXT("%s: %d moves handed out but there are %d!"), UTF8_TO_TCHAR(position), picked.Size(), legalMoves.Size());
+			passed = false;
+		}
+	}
+
+	return passed;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessEngineWorkerTests, "ChessTest.Search.Engine Worker", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool ChessEngineWorkerTests::RunTest(const FString& Parameters)
+{
+	static const double TimeoutSeconds = 10.0;
+
+	std::atomic<uint32> completedId(0);
+	std::atomic<int32> completions(0);
+	EngineWorker::CompletionCallback onComplete = [&completedId, &completions](uint32 searchId, const Search::Result& result)
+	{
+		completedId.store(searchId);
+		completions++;
+	};
+
+	auto waitFor = [&completions](int32 count)
+	{
+		double start = FPlatformTime::Seconds();
+		while (completions.load() < count && FPlatformTime::Seconds() - start < TimeoutSeconds)
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		return completions.load() >= count;
+	};
+
+	EngineWorker engine(16, 2);
+	Board board;
+	Search::Limits limits;
+	limits.MaxMilliseconds = 200;
+
+	//Starting a search cancels the one before it, only the second should complete
+	uint32 first = engine.StartSearch(board, limits, onComplete);
+	uint32 second = engine.StartSearch(board, limits, onComplete);
+	if (!waitFor(1) || completedId.load() != second || first == second)
+	{
+		UE_LOG(LogChessTest, Error, TEXT("Expected only search %u to complete, %u did"), second, completedId.load());
+		return false;
+	}
+
+	//A cancelled search never completes
+	engine.StartSearch(board, Search::Limits(), onComplete);
+	FPlatformProcess::Sleep(0.05f);
+	engine.Cancel();
+	FPlatformProcess::Sleep(0.05f);
+	if (completions.load() != 1 || engine.IsSearching())
+	{
+		UE_LOG(LogChessTest, Error, TEXT("A cancelled search completed or is still running!"));
+		return false;
+	}
+
+	//A stopped one completes with what it has
+	uint32 stopped = engine.StartSearch(board, Search::Limits(), onComplete);
+	FPlatformProcess::Sleep(0.05f);
+	engine.Stop();
+	if (!waitFor(2) || completedId.load() != stopped)
+	{
+		UE_LOG(LogChessTest, Error, TEXT("A stopped search didn't complete!"));
+		return false;
+	}
+
+	//Even one stopped before the worker has got round to starting it
+	stopped = engine.StartSearch(board, Search::Limits(), onComplete);
+	engine.Stop();
+	if (!waitFor(3) || completedId.load() != stopped)
+	{
+		UE_LOG(LogChessTest, Error, TEXT("A search stopped before it started didn't complete!"));
+		return false;
+	}
+
+	//A ponder search holds on to its result, even one it's finished, until it's hit
+	Search::Limits shallow;
+	shallow.MaxDepth = 2;
+	uint32 pondered = engine.StartSearch(board, shallow, onComplete, true);
+	FPlatformProcess::Sleep(0.1f);
+	if (completions.load() != 3 || !engine.PonderHit(limits.MaxMilliseconds) || !waitFor(4) || completedId.load() != pondered)
+	{
+		UE_LOG(LogChessTest, Error, TEXT("A ponder search completed before it was hit, or not after!"));
+		return false;
+	}
+
+	//And a missed one is cancelled like any other
+	engine.StartSearch(board, Search::Limits(), onComplete, true);
+	engine.Cancel();
+	if (engine.PonderHit(limits.MaxMilliseconds))
+	{
+		UE_LOG(LogChessTest, Error, TEXT("A cancelled ponder search was hit!"));
+		return false;
 	}
 
 	return true;
+}
+
+namespace
+{
+	//Walks every line to the depth, checking the incrementally kept evaluation terms against ones worked out from scratch
+	bool CheckEvaluationTerms(Board& board, int32 depth)
+	{
+		const State& state = board.BoardState;
+		if (state.PawnKey != state.ComputePawnKey() || state.PieceSquareScore != state.ComputePieceSquareScore() || state.Phase != state.ComputePhase())
+		{
+			return false;
+		}
+
+		if (depth == 0)
+		{
+			return true;
+		}
+
+		MoveList moves;
+		MoveGeneration::GenerateMoves(state, state.ColourToMove, moves);
+		for (const Move& move : moves)
+		{
+			board.ApplyMove(move);
+			bool correct = CheckEvaluationTerms(board, depth - 1);
+			board.UnmakeMove();
+
+			if (!correct)
+			{
+				UE_LOG(LogChessTest, Error, TEXT("Evaluation terms wrong after %s"), UTF8_TO_TCHAR(move.ToString().c_str()));
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessEvaluationTests, "ChessTest.Evaluation.Incremental", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool ChessEvaluationTests::RunTest(const FString& Parameters)
+{
+	//Each position comes with its mirror image, colours swapped, which has to score the same for the side to move
+	static const char* Positions[][2] =
+	{
+		{ "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1" },
+		{ "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1" },
+		{ "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", "8/4p1p1/8/1r3P1K/kp5R/3P4/2P5/8 b - - 0 1" },
+	};
+
+	PawnTable pawns;
+	bool passed = true;
+	for (const auto& position : Positions)
+	{
+		Board board(position[0]);
+		Board mirrored(position[1]);
+
+		int32 score = Evaluation::Evaluate(board.BoardState, pawns);
+		int32 mirroredScore = Evaluation::Evaluate(mirrored.BoardState, pawns);
+		if (score != mirroredScore)
+		{
+			UE_LOG(LogChessTest, Error, TEXT("%s scores %d but its mirror image scores %d!"), UTF8_TO_TCHAR(position[0]), score, mirroredScore);
+			passed = false;
+		}
+
+		passed &= CheckEvaluationTerms(board, 3);
+	}
+
+	return passed;
+}
+
+namespace
+{
+	//Walks every line to the depth, checking the network's incrementally updated score against one worked out from scratch
+	bool CheckNetworkEvaluation(Board& board, const Nnue::Network& network, int32 depth)
+	{
+		int32 score = Nnue::Evaluate(board);
+		int32 expected = Nnue::EvaluateFromScratch(network, board.BoardState);
+		if (score != expected)
+		{
+			UE_LOG(LogChessTest, Error, TEXT("Network scores %d incrementally but %d from scratch"), score, expected);
+			return false;
+		}
+
+		if (depth == 0)
+		{
+			return true;
+		}
+
+		MoveList moves;
+		MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove(), moves);
+		for (const Move& move : moves)
+		{
+			board.ApplyMove(move);
+			bool correct = CheckNetworkEvaluation(board, network, depth - 1);
+			board.UnmakeMove();
+
+			if (!correct)
+			{
+				UE_LOG(LogChessTest, Error, TEXT("Network evaluation wrong after %s"), UTF8_TO_TCHAR(move.ToString().c_str()));
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(ChessNetworkTests, "ChessTest.Evaluation.NNUE", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool ChessNetworkTests::RunTest(const FString& Parameters)
+{
+	//No trained network ships with the game, a random one exercises the same paths
+	Nnue::Network random;
+	random.Randomise(0x5EED);
+
+	std::stringstream file;
+	Nnue::Network network;
+	if (!random.Save(file) || !network.Load(file) || network.TransformerWeights != random.TransformerWeights || network.OutputWeights != random.OutputWeights)
+	{
+		UE_LOG(LogChessTest, Error, TEXT("Network didn't load back the same as it was saved!"));
+		return false;
+	}
+
+	std::stringstream truncated(file.str().substr(0, file.str().size() / 2));
+	if (network.Load(truncated))
+	{
+		UE_LOG(LogChessTest, Error, TEXT("Loaded a truncated network!"));
+		return false;
+	}
+
+	static const char* Positions[] =
+	{
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	};
+
+	bool passed = true;
+	for (const char* position : Positions)
+	{
+		Board board(position);
+		board.SetNetwork(&network);
+		passed &= CheckNetworkEvaluation(board, network, 3);
+	}
+
+	return passed;
 }
\ No newline at end of file
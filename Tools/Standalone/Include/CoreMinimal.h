@@ -0,0 +1,19 @@
+#pragma once
+
+//Stand-in for the engine's CoreMinimal.h when building the core outside Unreal, just the sized integer types it relies on
+//and the standard headers the engine would have pulled in along with them
+
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
\ No newline at end of file
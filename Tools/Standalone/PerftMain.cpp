@@ -0,0 +1,292 @@
+#include "CoreMinimal.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Board.h"
+#include "MoveGeneration.h"
+#include "MoveList.h"
+#include "Perft.h"
+
+using namespace std::chrono;
+using namespace Chess;
+
+namespace
+{
+	struct Options
+	{
+		std::string Fen = Constants::StandardStartFEN;
+		int32 Depth = 5;
+		int32 Threads = 1;
+		int32 HashMB = 0;
+		bool Compare = false;
+		bool Divide = false;
+		int64 Expected = -1;
+
+		std::string SuiteFile;
+		int64 MaxNodes = -1;
+		double MinNodesPerSecond = 0.0;
+	};
+
+	void PrintUsage()
+	{
+		printf(
+			"Usage: chess-perft [options]\n"
+			"  --fen <fen>       Position to count from, the standard start position by default\n"
+			"  --depth <n>       Plies to count, 5 by default\n"
+			"  --divide          Print the count below each root move\n"
+			"  --threads <n>     Split the count across threads, 0 for one per core\n"
+			"  --hash <mb>       Cache subtree counts in a table of this size\n"
+			"  --compare         With --hash, count again without the cache and report the speedup\n"
+			"  --expect <n>      Exit with an error if the total doesn't match\n"
+			"  --epd <file>      Check every position and depth in a perft suite instead, dividing any that are wrong\n"
+			"  --max-nodes <n>   Skip suite depths expected to count more leaves than this\n"
+			"  --min-nps <n>     Fail the suite if its overall nodes/sec falls below this\n");
+	}
+
+	bool ParseOptions(int argc, char** argv, Options& options)
+	{
+		for (int idx = 1; idx < argc; idx++)
+		{
+			std::string arg = argv[idx];
+			bool hasValue = idx + 1 < argc;
+
+			if (arg == "--divide")
+			{
+				options.Divide = true;
+			}
+			else if (arg == "--compare")
+			{
+				options.Compare = true;
+			}
+			else if (arg == "--fen" && hasValue)
+			{
+				options.Fen = argv[++idx];
+			}
+			else if (arg == "--depth" && hasValue)
+			{
+				options.Depth = std::atoi(argv[++idx]);
+			}
+			else if (arg == "--threads" && hasValue)
+			{
+				options.Threads = std::atoi(argv[++idx]);
+			}
+			else if (arg == "--hash" && hasValue)
+			{
+				options.HashMB = std::atoi(argv[++idx]);
+			}
+			else if (arg == "--expect" && hasValue)
+			{
+				options.Expected = std::atoll(argv[++idx]);
+			}
+			else if (arg == "--epd" && hasValue)
+			{
+				options.SuiteFile = argv[++idx];
+			}
+			else if (arg == "--max-nodes" && hasValue)
+			{
+				options.MaxNodes = std::atoll(argv[++idx]);
+			}
+			else if (arg == "--min-nps" && hasValue)
+			{
+				options.MinNodesPerSecond = std::atof(argv[++idx]);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		if (options.Threads == 0)
+		{
+			options.Threads = std::max<int32>(static_cast<int32>(std::thread::hardware_concurrency()), 1);
+		}
+
+		return options.Depth >= 0 && options.Threads > 0 && options.HashMB >= 0;
+	}
+
+	//Threaded count, with every thread sharing the cache if there is one
+	Perft::ParallelResult CountParallel(const Board& board, int32 depth, int32 threads, PerftCache* cache)
+	{
+		return cache != nullptr ? Perft::ParallelCount(board, depth, threads, *cache) : Perft::ParallelCount(board, depth, threads);
+	}
+
+	//Counts one subtree the way the options ask for
+	int64 CountSubtree(Board& board, int32 depth, const Options& options, PerftCache* cache)
+	{
+		if (options.Threads > 1)
+		{
+			return CountParallel(board, depth, options.Threads, cache).Nodes;
+		}
+
+		return cache != nullptr ? Perft::Count(board, depth, *cache) : Perft::Count(board, depth);
+	}
+
+	int RunSuite(const Options& options)
+	{
+		std::ifstream file(options.SuiteFile);
+		if (!file)
+		{
+			printf("Couldn't open %s\n", options.SuiteFile.c_str());
+			return 2;
+		}
+
+		int32 failures = 0;
+		int64 totalNodes = 0;
+		double totalSeconds = 0.0;
+
+		std::string line;
+		Perft::SuitePosition position;
+		while (std::getline(file, line))
+		{
+			if (!Perft::ParseSuiteLine(line, position))
+			{
+				continue;
+			}
+
+			std::string error;
+			if (!State::IsValidFEN(position.Fen, error))
+			{
+				printf("%s\n  invalid FEN: %s\n", position.Fen.c_str(), error.c_str());
+				failures++;
+				continue;
+			}
+
+			Board board(position.Fen);
+			printf("%s\n", position.Fen.c_str());
+			for (const std::pair<int32, int64>& expected : position.Expected)
+			{
+				if (options.MaxNodes >= 0 && expected.second > options.MaxNodes)
+				{
+					continue;
+				}
+
+				auto start = steady_clock::now();
+				int64 nodes = CountSubtree(board, expected.first, options, nullptr);
+				double seconds = duration<double>(steady_clock::now() - start).count();
+				totalNodes += nodes;
+				totalSeconds += seconds;
+
+				bool correct = nodes == expected.second;
+				printf("  D%d %lld %s, %.0f nodes/sec\n", expected.first, static_cast<long long>(nodes), correct ? "ok" : "FAILED",
+					seconds > 0.0 ? nodes / seconds : 0.0);
+				if (!correct)
+				{
+					printf("  expected %lld, divide:\n", static_cast<long long>(expected.second));
+					for (const std::pair<Move, int64>& subtree : Perft::Divide(board, expected.first))
+					{
+						printf("    %s: %lld\n", subtree.first.ToString().c_str(), static_cast<long long>(subtree.second));
+					}
+
+					failures++;
+				}
+			}
+		}
+
+		double nodesPerSecond = totalSeconds > 0.0 ? totalNodes / totalSeconds : 0.0;
+		printf("\n%d failed, %lld nodes in %.3f s, %.0f nodes/sec\n", failures, static_cast<long long>(totalNodes), totalSeconds, nodesPerSecond);
+		if (nodesPerSecond < options.MinNodesPerSecond)
+		{
+			printf("below the budget of %.0f nodes/sec\n", options.MinNodesPerSecond);
+			failures++;
+		}
+
+		return failures == 0 ? 0 : 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	if (!options.SuiteFile.empty())
+	{
+		return RunSuite(options);
+	}
+
+	std::string error;
+	if (!State::IsValidFEN(options.Fen, error))
+	{
+		printf("Invalid FEN: %s\n", error.c_str());
+		return 2;
+	}
+
+	Board board(options.Fen);
+	std::unique_ptr<PerftCache> cache(options.HashMB > 0 ? new PerftCache(options.HashMB) : nullptr);
+
+	auto start = steady_clock::now();
+	int64 nodes = 0;
+	if (options.Divide && options.Depth > 0)
+	{
+		MoveList moves;
+		MoveGeneration::GenerateMoves(board.BoardState, board.GetColourToMove(), moves);
+		for (const Move& move : moves)
+		{
+			board.ApplyMove(move);
+			int64 subtree = CountSubtree(board, options.Depth - 1, options, cache.get());
+			board.UnmakeMove();
+
+			printf("%s: %lld\n", move.ToString().c_str(), static_cast<long long>(subtree));
+			nodes += subtree;
+		}
+
+		printf("\n");
+	}
+	else if (options.Threads > 1)
+	{
+		//Report how the work spread out, which is the point of running threaded
+		Perft::ParallelResult result = CountParallel(board, options.Depth, options.Threads, cache.get());
+		for (size_t worker = 0; worker < result.Workers.size(); worker++)
+		{
+			const Perft::WorkerStats& stats = result.Workers[worker];
+			printf("thread %zu: %lld nodes, %d subtrees (%d stolen), %.0f nodes/sec\n", worker, static_cast<long long>(stats.Nodes),
+				stats.Subtrees, stats.Stolen, stats.NodesPerSecond());
+		}
+
+		nodes = result.Nodes;
+	}
+	else
+	{
+		nodes = CountSubtree(board, options.Depth, options, cache.get());
+	}
+
+	double seconds = duration<double>(steady_clock::now() - start).count();
+
+	printf("perft %d: %lld\n", options.Depth, static_cast<long long>(nodes));
+	printf("time: %.3f s, %.0f nodes/sec\n", seconds, seconds > 0.0 ? nodes / seconds : 0.0);
+	if (cache != nullptr)
+	{
+		printf("hash: %.1f%% of %lld probes hit\n", cache->GetHitRate() * 100.0, static_cast<long long>(cache->GetProbes()));
+	}
+
+	//The cache only earns its memory if it beats counting the same tree without it, on the same number of threads
+	if (cache != nullptr && options.Compare)
+	{
+		auto uncachedStart = steady_clock::now();
+		int64 uncachedNodes = CountSubtree(board, options.Depth, options, nullptr);
+		double uncachedSeconds = duration<double>(steady_clock::now() - uncachedStart).count();
+		printf("unhashed: %.3f s, %.2fx speedup\n", uncachedSeconds, seconds > 0.0 ? uncachedSeconds / seconds : 0.0);
+
+		if (uncachedNodes != nodes)
+		{
+			printf("unhashed count %lld doesn't match\n", static_cast<long long>(uncachedNodes));
+			return 1;
+		}
+	}
+
+	if (options.Expected >= 0 && nodes != options.Expected)
+	{
+		printf("expected %lld\n", static_cast<long long>(options.Expected));
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file